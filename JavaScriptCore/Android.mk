@@ -57,6 +57,7 @@ LOCAL_SRC_FILES := \
 	\
 	parser/Lexer.cpp \
 	parser/Nodes.cpp \
+	parser/ParsedProgramCache.cpp \
 	parser/Parser.cpp \
 	parser/ParserArena.cpp \
 	\
@@ -144,6 +145,7 @@ LOCAL_SRC_FILES := \
 	runtime/RegExpPrototype.cpp \
 	runtime/ScopeChain.cpp \
 	runtime/SmallStrings.cpp \
+	runtime/StorageAllocator.cpp \
 	runtime/StringConstructor.cpp \
 	runtime/StringObject.cpp \
 	runtime/StringPrototype.cpp \
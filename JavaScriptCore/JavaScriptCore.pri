@@ -110,6 +110,7 @@ SOURCES += \
     jit/JITStubs.cpp \
     parser/Lexer.cpp \
     parser/Nodes.cpp \
+    parser/ParsedProgramCache.cpp \
     parser/ParserArena.cpp \
     parser/Parser.cpp \
     profiler/Profile.cpp \
@@ -191,6 +192,7 @@ SOURCES += \
     runtime/RegExpPrototype.cpp \
     runtime/ScopeChain.cpp \
     runtime/SmallStrings.cpp \
+    runtime/StorageAllocator.cpp \
     runtime/StringConstructor.cpp \
     runtime/StringObject.cpp \
     runtime/StringPrototype.cpp \
@@ -37,6 +37,7 @@
 #include "JSStaticScopeObject.h"
 #include "Debugger.h"
 #include "BytecodeGenerator.h"
+#include "MegamorphicCache.h"
 #include <stdio.h>
 #include <wtf/StringExtras.h>
 
@@ -1297,6 +1298,10 @@ CodeBlock::CodeBlock(ScriptExecutable* ownerExecutable, CodeType codeType, PassR
 
 CodeBlock::~CodeBlock()
 {
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+    CodeBlockExecutionHistogram::record(this);
+#endif
+
 #if !ENABLE(JIT)
     for (size_t size = m_globalResolveInstructions.size(), i = 0; i < size; ++i)
         derefStructures(&m_instructions[m_globalResolveInstructions[i]]);
@@ -1309,8 +1314,12 @@ CodeBlock::~CodeBlock()
             m_globalResolveInfos[i].structure->deref();
     }
 
-    for (size_t size = m_structureStubInfos.size(), i = 0; i < size; ++i)
+    for (size_t size = m_structureStubInfos.size(), i = 0; i < size; ++i) {
+#ifdef ANDROID_INSTRUMENT
+        MegamorphicCache::recordSite(m_structureStubInfos[i].megamorphicCacheHits, m_structureStubInfos[i].megamorphicCacheMisses);
+#endif
         m_structureStubInfos[i].deref();
+    }
 
     for (size_t size = m_callLinkInfos.size(), i = 0; i < size; ++i) {
         CallLinkInfo* callLinkInfo = &m_callLinkInfos[i];
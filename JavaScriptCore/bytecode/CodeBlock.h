@@ -258,6 +258,32 @@ namespace JSC {
 #endif
     };
 
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+    // How often a CodeBlock has been entered and how many loop back edges it
+    // has run, to see how much code is too cold to be worth compiling.
+    struct ExecutionCounters {
+        ExecutionCounters()
+            : entryCount(0)
+            , loopIterationCount(0)
+            , jitCodeSize(0)
+        {
+        }
+
+#if ENABLE(TIERED_COMPILATION)
+        // A block that has been entered, or has run loop back edges, this often
+        // is compiled the next time it is entered.
+        static const uint32_t jitEntryThreshold = 16;
+        static const uint32_t jitLoopIterationThreshold = 1000;
+
+        bool reachedJITThreshold() const { return entryCount >= jitEntryThreshold || loopIterationCount >= jitLoopIterationThreshold; }
+#endif
+
+        uint32_t entryCount;
+        uint32_t loopIterationCount;
+        size_t jitCodeSize;
+    };
+#endif
+
     class CodeBlock : public FastAllocBase {
         friend class JIT;
     protected:
@@ -351,6 +377,10 @@ namespace JSC {
         Vector<Instruction>& instructions() { return m_instructions; }
         void discardBytecode() { m_instructions.clear(); }
 
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+        ExecutionCounters& executionCounters() { return m_executionCounters; }
+#endif
+
 #ifndef NDEBUG
         unsigned instructionCount() { return m_instructionCount; }
         void setInstructionCount(unsigned instructionCount) { m_instructionCount = instructionCount; }
@@ -542,6 +572,10 @@ namespace JSC {
 
         OwnPtr<ExceptionInfo> m_exceptionInfo;
 
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+        ExecutionCounters m_executionCounters;
+#endif
+
         struct RareData : FastAllocBase {
             Vector<HandlerInfo> m_exceptionHandlers;
 
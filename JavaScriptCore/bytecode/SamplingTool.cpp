@@ -32,6 +32,7 @@
 #include "CodeBlock.h"
 #include "Interpreter.h"
 #include "Opcode.h"
+#include <wtf/StringExtras.h>
 
 #if !OS(WINDOWS)
 #include <unistd.h>
@@ -386,6 +387,70 @@ void SamplingTool::dump(ExecState*)
 
 #endif
 
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+
+// Upper bound (exclusive) on the entry count of each bucket; the last bucket is open ended.
+static const uint32_t executionHistogramBucketLimits[] = { 2, 16, 256, 4096 };
+static const size_t executionHistogramBucketCount = sizeof(executionHistogramBucketLimits) / sizeof(executionHistogramBucketLimits[0]) + 1;
+
+struct ExecutionHistogramBucket {
+    uint64_t codeBlocks;
+    uint64_t bytecodeInstructions;
+    uint64_t jitCodeBytes;
+    uint64_t entries;
+    uint64_t loopIterations;
+};
+
+static ExecutionHistogramBucket executionHistogram[executionHistogramBucketCount];
+
+void CodeBlockExecutionHistogram::record(CodeBlock* codeBlock)
+{
+    const ExecutionCounters& counters = codeBlock->executionCounters();
+    size_t bucket = 0;
+    while (bucket < executionHistogramBucketCount - 1 && counters.entryCount >= executionHistogramBucketLimits[bucket])
+        ++bucket;
+
+    ExecutionHistogramBucket& histogramBucket = executionHistogram[bucket];
+    ++histogramBucket.codeBlocks;
+    histogramBucket.bytecodeInstructions += codeBlock->instructions().size();
+    histogramBucket.jitCodeBytes += counters.jitCodeSize;
+    histogramBucket.entries += counters.entryCount;
+    histogramBucket.loopIterations += counters.loopIterationCount;
+}
+
+void CodeBlockExecutionHistogram::dump()
+{
+    uint64_t totalCodeBlocks = 0;
+    uint64_t totalJITCodeBytes = 0;
+    for (size_t i = 0; i < executionHistogramBucketCount; ++i) {
+        totalCodeBlocks += executionHistogram[i].codeBlocks;
+        totalJITCodeBytes += executionHistogram[i].jitCodeBytes;
+    }
+    if (!totalCodeBlocks)
+        return;
+
+    printf("\nCodeBlock execution histogram (%llu code blocks)\n", static_cast<unsigned long long>(totalCodeBlocks));
+    printf("entries        blocks   %% blocks   bytecode    JIT bytes  %% JIT    loop iterations\n");
+    printf("-------------------------------------------------------------------------------\n");
+    for (size_t i = 0; i < executionHistogramBucketCount; ++i) {
+        const ExecutionHistogramBucket& bucket = executionHistogram[i];
+        char range[32];
+        uint32_t lower = i ? executionHistogramBucketLimits[i - 1] : 0;
+        if (i < executionHistogramBucketCount - 1)
+            snprintf(range, sizeof(range), "%u-%u", lower, executionHistogramBucketLimits[i] - 1);
+        else
+            snprintf(range, sizeof(range), "%u+", lower);
+        printf("%-12s %8llu   %6.2f%%  %9llu  %11llu  %6.2f%%  %15llu\n", range,
+            static_cast<unsigned long long>(bucket.codeBlocks), (100.0 * bucket.codeBlocks) / totalCodeBlocks,
+            static_cast<unsigned long long>(bucket.bytecodeInstructions), static_cast<unsigned long long>(bucket.jitCodeBytes),
+            totalJITCodeBytes ? (100.0 * bucket.jitCodeBytes) / totalJITCodeBytes : 0.0,
+            static_cast<unsigned long long>(bucket.loopIterations));
+    }
+    printf("\n");
+}
+
+#endif
+
 void AbstractSamplingCounter::dump()
 {
 #if ENABLE(SAMPLING_COUNTERS)
@@ -273,6 +273,19 @@ namespace JSC {
 #endif
     };
 
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+    // CodeBlockExecutionHistogram:
+    //
+    // Buckets every CodeBlock by how often it was entered over its lifetime, as
+    // recorded by its ExecutionCounters, and prints how much bytecode and JIT code
+    // each bucket accounts for. Blocks are recorded as they are destroyed.
+    class CodeBlockExecutionHistogram {
+    public:
+        static void record(CodeBlock*);
+        static void dump();
+    };
+#endif
+
     // AbstractSamplingCounter:
     //
     // Implements a named set of counters, printed on exit if ENABLE(SAMPLING_COUNTERS).
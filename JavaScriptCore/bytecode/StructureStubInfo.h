@@ -55,6 +55,10 @@ namespace JSC {
         StructureStubInfo(AccessType accessType)
             : accessType(accessType)
             , seen(false)
+#ifdef ANDROID_INSTRUMENT
+            , megamorphicCacheHits(0)
+            , megamorphicCacheMisses(0)
+#endif
         {
         }
 
@@ -143,6 +147,13 @@ namespace JSC {
         int accessType : 31;
         int seen : 1;
 
+#ifdef ANDROID_INSTRUMENT
+        // Recorded into MegamorphicCache::siteStatistics() when the CodeBlock
+        // is destroyed.
+        unsigned megamorphicCacheHits;
+        unsigned megamorphicCacheMisses;
+#endif
+
         union {
             struct {
                 Structure* baseObjectStructure;
@@ -78,6 +78,9 @@ void Debugger::recompileAllJSFunctions(JSGlobalData* globalData)
             continue;
 
         FunctionExecutable* executable = function->jsExecutable();
+        // The recompiled code is only reachable through functions that the
+        // collector may not visit again.
+        Heap::writeBarrier(function);
 
         // Check if the function is already in the set - if so,
         // we've already retranslated it, nothing to do here.
@@ -70,9 +70,45 @@ using namespace std;
 
 namespace JSC {
 
+#if ENABLE(TIERED_COMPILATION)
+// Code starts out in the interpreter. Once its CodeBlock is hot it is compiled, and every
+// later entry runs the JIT code; activations already in the interpreter finish there.
+static inline bool shouldExecuteInJIT(ExecutableBase* executable, CodeBlock* codeBlock)
+{
+    return executable->hasJITCode() || codeBlock->executionCounters().reachedJITThreshold();
+}
+
+static inline bool isBytecodePC(CodeBlock* codeBlock, void* pc)
+{
+    Instruction* vPC = static_cast<Instruction*>(pc);
+    return vPC >= codeBlock->instructions().begin() && vPC < codeBlock->instructions().end();
+}
+
+// Interpreted frames return to an instruction in their caller's bytecode and JIT frames to
+// an address in their caller's JIT code. A JIT frame called from interpreted code returns to
+// ctiTrampoline instead, and its caller belongs to the interpreter activation below.
+static bool returnsIntoCodeBlock(CodeBlock* codeBlock, void* pc)
+{
+    if (isBytecodePC(codeBlock, pc))
+        return true;
+
+    ExecutableBase* executable = codeBlock->ownerExecutable();
+    if (!executable->hasJITCode())
+        return false;
+
+    JITCode& jitCode = executable->generatedJITCode();
+    char* start = static_cast<char*>(jitCode.addressForCall().executableAddress());
+    return static_cast<char*>(pc) > start && static_cast<char*>(pc) < start + jitCode.size();
+}
+#endif
+
 static ALWAYS_INLINE unsigned bytecodeOffsetForPC(CallFrame* callFrame, CodeBlock* codeBlock, void* pc)
 {
-#if ENABLE(JIT)
+#if ENABLE(TIERED_COMPILATION)
+    if (isBytecodePC(codeBlock, pc))
+        return static_cast<Instruction*>(pc) - codeBlock->instructions().begin();
+    return codeBlock->getBytecodeIndex(callFrame, ReturnAddressPtr(pc));
+#elif ENABLE(JIT)
     return codeBlock->getBytecodeIndex(callFrame, ReturnAddressPtr(pc));
 #else
     UNUSED_PARAM(callFrame);
@@ -169,6 +205,7 @@ NEVER_INLINE bool Interpreter::resolveGlobal(CallFrame* callFrame, Instruction*
     PropertySlot slot(globalObject);
     if (globalObject->getPropertySlot(callFrame, ident, slot)) {
         JSValue result = slot.getValue(callFrame, ident);
+#if !ENABLE(TIERED_COMPILATION)
         if (slot.isCacheable() && !globalObject->structure()->isUncacheableDictionary() && slot.slotBase() == globalObject) {
             if (vPC[4].u.structure)
                 vPC[4].u.structure->deref();
@@ -178,6 +215,7 @@ NEVER_INLINE bool Interpreter::resolveGlobal(CallFrame* callFrame, Instruction*
             callFrame->r(dst) = JSValue(result);
             return true;
         }
+#endif
 
         exceptionValue = callFrame->globalData().exception;
         if (exceptionValue)
@@ -484,6 +522,11 @@ NEVER_INLINE bool Interpreter::unwindCallFrame(CallFrame*& callFrame, JSValue ex
         return false;
 
     codeBlock = callFrame->codeBlock();
+#if ENABLE(TIERED_COMPILATION)
+    // The interpreter unwinds its own frames once the JIT activation has returned.
+    if (!returnsIntoCodeBlock(codeBlock, returnPC))
+        return false;
+#endif
     bytecodeOffset = bytecodeOffsetForPC(callFrame, codeBlock, returnPC);
     return true;
 }
@@ -616,7 +659,12 @@ JSValue Interpreter::execute(ProgramExecutable* program, CallFrame* callFrame, S
         SamplingTool::CallRecord callRecord(m_sampler.get());
 
         m_reentryDepth++;
-#if ENABLE(JIT)
+#if ENABLE(TIERED_COMPILATION)
+        if (shouldExecuteInJIT(program, codeBlock))
+            result = program->jitCode(newCallFrame, scopeChain).execute(&m_registerFile, newCallFrame, scopeChain->globalData, exception);
+        else
+            result = privateExecute(Normal, &m_registerFile, newCallFrame, exception);
+#elif ENABLE(JIT)
         result = program->jitCode(newCallFrame, scopeChain).execute(&m_registerFile, newCallFrame, scopeChain->globalData, exception);
 #else
         result = privateExecute(Normal, &m_registerFile, newCallFrame, exception);
@@ -682,7 +730,12 @@ JSValue Interpreter::execute(FunctionExecutable* functionExecutable, CallFrame*
         SamplingTool::CallRecord callRecord(m_sampler.get());
 
         m_reentryDepth++;
-#if ENABLE(JIT)
+#if ENABLE(TIERED_COMPILATION)
+        if (shouldExecuteInJIT(functionExecutable, codeBlock))
+            result = functionExecutable->jitCode(newCallFrame, scopeChain).execute(&m_registerFile, newCallFrame, scopeChain->globalData, exception);
+        else
+            result = privateExecute(Normal, &m_registerFile, newCallFrame, exception);
+#elif ENABLE(JIT)
         result = functionExecutable->jitCode(newCallFrame, scopeChain).execute(&m_registerFile, newCallFrame, scopeChain->globalData, exception);
 #else
         result = privateExecute(Normal, &m_registerFile, newCallFrame, exception);
@@ -730,7 +783,7 @@ CallFrameClosure Interpreter::prepareForRepeatCall(FunctionExecutable* FunctionE
     }
     // a 0 codeBlock indicates a built-in caller
     newCallFrame->init(codeBlock, 0, scopeChain, callFrame->addHostCallFrameFlag(), 0, argc, function);
-#if ENABLE(JIT)
+#if ENABLE(JIT) && !ENABLE(TIERED_COMPILATION)
     FunctionExecutable->jitCode(newCallFrame, scopeChain);
 #endif
 
@@ -750,7 +803,12 @@ JSValue Interpreter::execute(CallFrameClosure& closure, JSValue* exception)
         SamplingTool::CallRecord callRecord(m_sampler.get());
         
         m_reentryDepth++;
-#if ENABLE(JIT)
+#if ENABLE(TIERED_COMPILATION)
+        if (shouldExecuteInJIT(closure.functionExecutable, closure.newCallFrame->codeBlock()))
+            result = closure.functionExecutable->jitCode(closure.newCallFrame, closure.scopeChain).execute(&m_registerFile, closure.newCallFrame, closure.globalData, exception);
+        else
+            result = privateExecute(Normal, &m_registerFile, closure.newCallFrame, exception);
+#elif ENABLE(JIT)
         result = closure.functionExecutable->generatedJITCode().execute(&m_registerFile, closure.newCallFrame, closure.globalData, exception);
 #else
         result = privateExecute(Normal, &m_registerFile, closure.newCallFrame, exception);
@@ -844,7 +902,12 @@ JSValue Interpreter::execute(EvalExecutable* eval, CallFrame* callFrame, JSObjec
         SamplingTool::CallRecord callRecord(m_sampler.get());
 
         m_reentryDepth++;
-#if ENABLE(JIT)
+#if ENABLE(TIERED_COMPILATION)
+        if (shouldExecuteInJIT(eval, codeBlock))
+            result = eval->jitCode(newCallFrame, scopeChain).execute(&m_registerFile, newCallFrame, scopeChain->globalData, exception);
+        else
+            result = privateExecute(Normal, &m_registerFile, newCallFrame, exception);
+#elif ENABLE(JIT)
         result = eval->jitCode(newCallFrame, scopeChain).execute(&m_registerFile, newCallFrame, scopeChain->globalData, exception);
 #else
         result = privateExecute(Normal, &m_registerFile, newCallFrame, exception);
@@ -902,6 +965,11 @@ NEVER_INLINE ScopeChainNode* Interpreter::createExceptionScope(CallFrame* callFr
 
 NEVER_INLINE void Interpreter::tryCachePutByID(CallFrame* callFrame, CodeBlock* codeBlock, Instruction* vPC, JSValue baseValue, const PutPropertySlot& slot)
 {
+#if ENABLE(TIERED_COMPILATION)
+    // The JIT compiles this block from its bytecode once it is hot, so leave the instructions unspecialized.
+    return;
+#endif
+
     // Recursive invocation may already have specialized this instruction.
     if (vPC[0].u.opcode != getOpcode(op_put_by_id))
         return;
@@ -978,6 +1046,11 @@ NEVER_INLINE void Interpreter::uncachePutByID(CodeBlock* codeBlock, Instruction*
 
 NEVER_INLINE void Interpreter::tryCacheGetByID(CallFrame* callFrame, CodeBlock* codeBlock, Instruction* vPC, JSValue baseValue, const Identifier& propertyName, const PropertySlot& slot)
 {
+#if ENABLE(TIERED_COMPILATION)
+    // The JIT compiles this block from its bytecode once it is hot, so leave the instructions unspecialized.
+    return;
+#endif
+
     // Recursive invocation may already have specialized this instruction.
     if (vPC[0].u.opcode != getOpcode(op_get_by_id))
         return;
@@ -1086,6 +1159,30 @@ NEVER_INLINE void Interpreter::uncacheGetByID(CodeBlock* codeBlock, Instruction*
     vPC[4] = 0;
 }
 
+#if ENABLE(TIERED_COMPILATION)
+ALWAYS_INLINE bool Interpreter::shouldCallIntoJIT(FunctionExecutable* functionExecutable, CodeBlock* codeBlock) const
+{
+    // Each call into the JIT nests a native activation; past the reentry limit keep interpreting instead.
+    if (m_reentryDepth >= MaxSecondaryThreadReentryDepth && (!isMainThread() || m_reentryDepth >= MaxMainThreadReentryDepth))
+        return false;
+    return shouldExecuteInJIT(functionExecutable, codeBlock);
+}
+
+// Runs a callee the interpreter has set up a frame for in its JIT code. The JIT code returns
+// to ctiTrampoline rather than into the caller's bytecode, and hands back an exception it does
+// not catch in exceptionValue.
+NEVER_INLINE JSValue Interpreter::callIntoJIT(FunctionExecutable* functionExecutable, RegisterFile* registerFile, CallFrame* callFrame, JSValue& exceptionValue)
+{
+    JITCode& jitCode = functionExecutable->jitCode(callFrame, callFrame->scopeChain());
+
+    exceptionValue = JSValue();
+    m_reentryDepth++;
+    JSValue result = jitCode.execute(registerFile, callFrame, &callFrame->globalData(), &exceptionValue);
+    m_reentryDepth--;
+    return result;
+}
+#endif
+
 #endif // USE(INTERPRETER)
 
 JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFile, CallFrame* callFrame, JSValue* exception)
@@ -1103,8 +1200,8 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
         return JSValue();
     }
 
-#if ENABLE(JIT)
-    // Mixing Interpreter + JIT is not supported.
+#if ENABLE(JIT) && !ENABLE(TIERED_COMPILATION)
+    // Mixing Interpreter + JIT is only supported by tiered compilation.
     ASSERT_NOT_REACHED();
 #endif
 #if !USE(INTERPRETER)
@@ -1134,7 +1231,14 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
     OpcodeStats::resetLastInstruction();
 #endif
 
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+#define COUNT_LOOP_ITERATION() ++callFrame->codeBlock()->executionCounters().loopIterationCount
+#else
+#define COUNT_LOOP_ITERATION()
+#endif
+
 #define CHECK_FOR_TIMEOUT() \
+    COUNT_LOOP_ITERATION(); \
     if (!--tickCount) { \
         if (globalData->timeoutChecker.didTimeOut(callFrame)) { \
             exceptionValue = jsNull(); \
@@ -3069,6 +3173,20 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
             }
 
             callFrame->init(newCodeBlock, vPC + 5, callDataScopeChain, previousCallFrame, dst, argCount, asFunction(v));
+
+#if ENABLE(TIERED_COMPILATION)
+            if (shouldCallIntoJIT(callData.js.functionExecutable, newCodeBlock)) {
+                JSValue returnValue = callIntoJIT(callData.js.functionExecutable, registerFile, callFrame, exceptionValue);
+                callFrame = previousCallFrame;
+                vPC += OPCODE_LENGTH(op_call);
+                // Like an interpreted callee, an uncaught exception is rethrown at the return address.
+                if (exceptionValue)
+                    goto vm_throw;
+                callFrame->r(dst) = returnValue;
+                NEXT_INSTRUCTION();
+            }
+#endif
+
             vPC = newCodeBlock->instructions().begin();
 
 #if ENABLE(OPCODE_STATS)
@@ -3223,6 +3341,19 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
             }
             
             callFrame->init(newCodeBlock, vPC + 5, callDataScopeChain, previousCallFrame, dst, argCount, asFunction(v));
+
+#if ENABLE(TIERED_COMPILATION)
+            if (shouldCallIntoJIT(callData.js.functionExecutable, newCodeBlock)) {
+                JSValue returnValue = callIntoJIT(callData.js.functionExecutable, registerFile, callFrame, exceptionValue);
+                callFrame = previousCallFrame;
+                vPC += OPCODE_LENGTH(op_call_varargs);
+                if (exceptionValue)
+                    goto vm_throw;
+                callFrame->r(dst) = returnValue;
+                NEXT_INSTRUCTION();
+            }
+#endif
+
             vPC = newCodeBlock->instructions().begin();
             
 #if ENABLE(OPCODE_STATS)
@@ -3346,6 +3477,9 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
 
         size_t i = 0;
         CodeBlock* codeBlock = callFrame->codeBlock();
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+        ++codeBlock->executionCounters().entryCount;
+#endif
         
         for (size_t count = codeBlock->m_numVars; i < count; ++i)
             callFrame->r(i) = jsUndefined();
@@ -3368,6 +3502,9 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
 
         size_t i = 0;
         CodeBlock* codeBlock = callFrame->codeBlock();
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+        ++codeBlock->executionCounters().entryCount;
+#endif
 
         for (size_t count = codeBlock->m_numVars; i < count; ++i)
             callFrame->r(i) = jsUndefined();
@@ -3481,6 +3618,19 @@ JSValue Interpreter::privateExecute(ExecutionFlag flag, RegisterFile* registerFi
             }
 
             callFrame->init(newCodeBlock, vPC + 7, callDataScopeChain, previousCallFrame, dst, argCount, asFunction(v));
+
+#if ENABLE(TIERED_COMPILATION)
+            if (shouldCallIntoJIT(constructData.js.functionExecutable, newCodeBlock)) {
+                JSValue returnValue = callIntoJIT(constructData.js.functionExecutable, registerFile, callFrame, exceptionValue);
+                callFrame = previousCallFrame;
+                vPC += OPCODE_LENGTH(op_construct);
+                if (exceptionValue)
+                    goto vm_throw;
+                callFrame->r(dst) = returnValue;
+                NEXT_INSTRUCTION();
+            }
+#endif
+
             vPC = newCodeBlock->instructions().begin();
 
 #if ENABLE(OPCODE_STATS)
@@ -3958,6 +4108,11 @@ void Interpreter::retrieveLastCaller(CallFrame* callFrame, int& lineNumber, intp
     if (!callerCodeBlock)
         return;
 
+#if ENABLE(TIERED_COMPILATION)
+    if (!returnsIntoCodeBlock(callerCodeBlock, callFrame->returnPC()))
+        return;
+#endif
+
     unsigned bytecodeOffset = bytecodeOffsetForPC(callerFrame, callerCodeBlock, callFrame->returnPC());
     lineNumber = callerCodeBlock->lineNumberForBytecodeOffset(callerFrame, bytecodeOffset - 1);
     sourceID = callerCodeBlock->ownerExecutable()->sourceID();
@@ -139,6 +139,11 @@ namespace JSC {
 
         NEVER_INLINE bool unwindCallFrame(CallFrame*&, JSValue, unsigned& bytecodeOffset, CodeBlock*&);
 
+#if ENABLE(TIERED_COMPILATION)
+        ALWAYS_INLINE bool shouldCallIntoJIT(FunctionExecutable*, CodeBlock*) const;
+        NEVER_INLINE JSValue callIntoJIT(FunctionExecutable*, RegisterFile*, CallFrame*, JSValue& exceptionValue);
+#endif
+
         static ALWAYS_INLINE CallFrame* slideRegisterWindowForCall(CodeBlock*, RegisterFile*, CallFrame*, size_t registerOffset, int argc);
 
         static CallFrame* findFunctionCallFrame(CallFrame*, InternalFunction*);
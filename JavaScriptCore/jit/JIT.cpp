@@ -95,6 +95,9 @@ JIT::JIT(JSGlobalData* globalData, CodeBlock* codeBlock)
 #if USE(JSVALUE32_64)
 void JIT::emitTimeoutCheck()
 {
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+    add32(Imm32(1), AbsoluteAddress(&m_codeBlock->executionCounters().loopIterationCount));
+#endif
     Jump skipTimeout = branchSub32(NonZero, Imm32(1), timeoutCheckRegister);
     JITStubCall stubCall(this, cti_timeout_check);
     stubCall.addArgument(regT1, regT0); // save last result registers.
@@ -105,6 +108,9 @@ void JIT::emitTimeoutCheck()
 #else
 void JIT::emitTimeoutCheck()
 {
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+    add32(Imm32(1), AbsoluteAddress(&m_codeBlock->executionCounters().loopIterationCount));
+#endif
     Jump skipTimeout = branchSub32(NonZero, Imm32(1), timeoutCheckRegister);
     JITStubCall(this, cti_timeout_check).call(timeoutCheckRegister);
     skipTimeout.link(this);
@@ -449,6 +455,9 @@ JITCode JIT::privateCompile()
 #if ENABLE(OPCODE_SAMPLING)
     sampleInstruction(m_codeBlock->instructions().begin());
 #endif
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+    add32(Imm32(1), AbsoluteAddress(&m_codeBlock->executionCounters().entryCount));
+#endif
 
     // Could use a pop_m, but would need to offset the following instruction if so.
     preserveReturnAddressAfterCall(regT2);
@@ -524,6 +533,11 @@ JITCode JIT::privateCompile()
     }
 
     if (m_codeBlock->hasExceptionInfo()) {
+#if ENABLE(TIERED_COMPILATION)
+        // Exception info regenerated while this block was still interpreted already
+        // holds the offsets of an identical compile.
+        m_codeBlock->callReturnIndexVector().clear();
+#endif
         m_codeBlock->callReturnIndexVector().reserveCapacity(m_calls.size());
         for (Vector<CallRecord>::iterator iter = m_calls.begin(); iter != m_calls.end(); ++iter)
             m_codeBlock->callReturnIndexVector().append(CallReturnOffsetToBytecodeIndex(patchBuffer.returnAddressOffset(iter->from), iter->bytecodeIndex));
@@ -557,6 +571,10 @@ JITCode JIT::privateCompile()
         info.callReturnLocation = m_codeBlock->structureStubInfo(m_methodCallCompilationInfo[i].propertyAccessIndex).callReturnLocation;
     }
 
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+    m_codeBlock->executionCounters().jitCodeSize = m_assembler.size();
+#endif
+
     return patchBuffer.finalizeCode();
 }
 
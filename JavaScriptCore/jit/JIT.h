@@ -870,6 +870,10 @@ namespace JSC {
         void emitGetFromCallFrameHeaderPtr(RegisterFile::CallFrameHeaderEntry entry, RegisterID to, RegisterID from = callFrameRegister);
         void emitGetFromCallFrameHeader32(RegisterFile::CallFrameHeaderEntry entry, RegisterID to, RegisterID from = callFrameRegister);
 
+#if ENABLE(JSC_WRITE_BARRIER)
+        void emitWriteBarrier(RegisterID owner, RegisterID scratch);
+#endif
+
         JSValue getConstantOperand(unsigned src);
         bool isOperandConstantImmediateInt(unsigned src);
 
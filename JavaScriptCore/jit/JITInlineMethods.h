@@ -102,6 +102,17 @@ ALWAYS_INLINE void JIT::emitGetFromCallFrameHeader32(RegisterFile::CallFrameHead
 #endif
 }
 
+#if ENABLE(JSC_WRITE_BARRIER)
+// Inline version of Heap::writeBarrier(): dirties the card of the
+// CollectorBlock containing owner.
+ALWAYS_INLINE void JIT::emitWriteBarrier(RegisterID owner, RegisterID scratch)
+{
+    move(owner, scratch);
+    andPtr(Imm32(static_cast<int32_t>(BLOCK_MASK)), scratch);
+    store32(Imm32(1), Address(scratch, OBJECT_OFFSETOF(CollectorBlock, dirty)));
+}
+#endif
+
 ALWAYS_INLINE JIT::Call JIT::emitNakedCall(CodePtr function)
 {
     ASSERT(m_bytecodeIndex != (unsigned)-1); // This method should only be called during hot/cold path generation, so that m_bytecodeIndex is set.
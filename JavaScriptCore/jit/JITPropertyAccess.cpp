@@ -324,6 +324,11 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
 
     loadPtr(Address(regT0, OBJECT_OFFSETOF(JSArray, m_storage)), regT3);
 
+#if ENABLE(JSC_WRITE_BARRIER)
+    // regT1 holds the base's cell tag, which is not needed again.
+    emitWriteBarrier(regT0, regT1);
+#endif
+
     Jump empty = branch32(Equal, BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0]) + 4), Imm32(JSValue::EmptyValueTag));
 
     Label storeResult(this);
@@ -459,6 +464,13 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
 
     emitJumpSlowCaseIfNotJSCell(base, regT1);
 
+#if ENABLE(JSC_WRITE_BARRIER)
+    // The barrier goes before hotPathBegin so the patch offsets are unchanged.
+    // regT1 is known to hold the cell tag, so borrow it and put it back.
+    emitWriteBarrier(regT0, regT1);
+    move(Imm32(JSValue::CellTag), regT1);
+#endif
+
     BEGIN_UNINTERRUPTED_SEQUENCE(sequencePutById);
 
     Label hotPathBegin(this);
@@ -1127,6 +1139,10 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
 
     loadPtr(Address(regT0, OBJECT_OFFSETOF(JSArray, m_storage)), regT2);
 
+#if ENABLE(JSC_WRITE_BARRIER)
+    emitWriteBarrier(regT0, regT3);
+#endif
+
     Jump empty = branchTestPtr(Zero, BaseIndex(regT2, regT1, ScalePtr, OBJECT_OFFSETOF(ArrayStorage, m_vector[0])));
 
     Label storeResult(this);
@@ -1414,6 +1430,11 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
     // Jump to a slow case if either the base object is an immediate, or if the Structure does not match.
     emitJumpSlowCaseIfNotJSCell(regT0, baseVReg);
 
+#if ENABLE(JSC_WRITE_BARRIER)
+    // The barrier goes before hotPathBegin so the patch offsets are unchanged.
+    emitWriteBarrier(regT0, regT2);
+#endif
+
     BEGIN_UNINTERRUPTED_SEQUENCE(sequencePutById);
 
     Label hotPathBegin(this);
@@ -48,6 +48,7 @@
 #include "JSPropertyNameIterator.h"
 #include "JSStaticScopeObject.h"
 #include "JSString.h"
+#include "MegamorphicCache.h"
 #include "ObjectPrototype.h"
 #include "Operations.h"
 #include "Parser.h"
@@ -1202,16 +1203,45 @@ DEFINE_STUB_FUNCTION(void, op_put_by_id_generic)
     CHECK_FOR_EXCEPTION_AT_END();
 }
 
-DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_generic)
+// Sites whose inline caches have given up share one MegamorphicCache, which
+// finds own properties without going through getOwnPropertySlot.
+static inline JSValue getByIdMegamorphic(CallFrame* callFrame, JSValue baseValue, const Identifier& ident, ReturnAddressPtr returnAddress)
 {
-    STUB_INIT_STACK_FRAME(stackFrame);
+    MegamorphicCache* cache = callFrame->globalData().megamorphicCache;
+#if defined(ANDROID_INSTRUMENT) && ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS)
+    StructureStubInfo& stubInfo = callFrame->codeBlock()->getStubInfo(returnAddress);
+#else
+    UNUSED_PARAM(returnAddress);
+#endif
 
-    CallFrame* callFrame = stackFrame.callFrame;
-    Identifier& ident = stackFrame.args[1].identifier();
+    JSValue result;
+    if (baseValue.isCell() && cache->get(asCell(baseValue), ident, result)) {
+#if defined(ANDROID_INSTRUMENT) && ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS)
+        ++stubInfo.megamorphicCacheHits;
+#endif
+        return result;
+    }
+#if defined(ANDROID_INSTRUMENT) && ENABLE(JIT_OPTIMIZE_PROPERTY_ACCESS)
+    ++stubInfo.megamorphicCacheMisses;
+#endif
 
-    JSValue baseValue = stackFrame.args[0].jsValue();
     PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(callFrame, ident, slot);
+    result = baseValue.get(callFrame, ident, slot);
+
+    if (baseValue.isCell()
+        && slot.isCacheable()
+        && slot.slotBase() == baseValue
+        && !asCell(baseValue)->structure()->isDictionary())
+        cache->add(asCell(baseValue), ident, slot.cachedOffset());
+
+    return result;
+}
+
+DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_generic)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+
+    JSValue result = getByIdMegamorphic(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier(), STUB_RETURN_ADDRESS);
 
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
@@ -1499,9 +1529,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_list_full)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
 
-    JSValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(stackFrame.callFrame, stackFrame.args[1].identifier(), slot);
+    JSValue result = getByIdMegamorphic(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier(), STUB_RETURN_ADDRESS);
 
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
@@ -1511,9 +1539,7 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_proto_fail)
 {
     STUB_INIT_STACK_FRAME(stackFrame);
 
-    JSValue baseValue = stackFrame.args[0].jsValue();
-    PropertySlot slot(baseValue);
-    JSValue result = baseValue.get(stackFrame.callFrame, stackFrame.args[1].identifier(), slot);
+    JSValue result = getByIdMegamorphic(stackFrame.callFrame, stackFrame.args[0].jsValue(), stackFrame.args[1].identifier(), STUB_RETURN_ADDRESS);
 
     CHECK_FOR_EXCEPTION_AT_END();
     return JSValue::encode(result);
@@ -359,6 +359,9 @@ static void cleanupGlobalData(JSGlobalData* globalData)
 {
     JSLock lock(SilenceAssertionsOnly);
     globalData->heap.destroy();
+#if ENABLE(CODEBLOCK_EXECUTION_COUNTERS)
+    CodeBlockExecutionHistogram::dump();
+#endif
     globalData->deref();
 }
 
@@ -137,6 +137,7 @@ void Lexer::setCode(const SourceCode& source, ParserArena& arena)
     m_arena = &arena.identifierArena();
 
     m_lineNumber = source.firstLine();
+    m_skippedLineCount = 0;
     m_delimited = false;
     m_lastToken = -1;
 
@@ -197,6 +198,41 @@ void Lexer::shiftLineTerminator()
     ++m_lineNumber;
 }
 
+// Counts line terminators the same way shiftLineTerminator does, treating CRLF and LFCR as one.
+static int countLineTerminators(const UChar* begin, const UChar* end)
+{
+    int count = 0;
+    for (const UChar* p = begin; p < end; ++p) {
+        if (!Lexer::isLineTerminator(*p))
+            continue;
+        if (p + 1 < end && *p + p[1] == '\n' + '\r')
+            ++p;
+        ++count;
+    }
+    return count;
+}
+
+// Moves the lexer from a function body's open brace to its close brace if the body
+// has already been parsed successfully; the parser then sees an empty body. Inner
+// bodies are only ever parsed for syntax errors, so nothing is lost, and an
+// enclosing function no longer rescans every function nested inside it.
+bool Lexer::skipFunctionBody(int openBrace)
+{
+    if (openBrace == m_source->startOffset() || !m_codeWithoutBOMs.isEmpty())
+        return false;
+
+    const FunctionBodyExtent* extent = m_source->provider()->functionBodyExtent(openBrace);
+    if (!extent || extent->closeBrace >= m_source->endOffset())
+        return false;
+
+    m_code = m_codeStart + extent->closeBrace;
+    shift4();
+    ASSERT(m_current == '}');
+    // The open brace token still reports the line it started on.
+    m_skippedLineCount = extent->lineCount;
+    return true;
+}
+
 ALWAYS_INLINE const Identifier* Lexer::makeIdentifier(const UChar* characters, size_t length)
 {
     return &m_arena->makeIdentifier(m_globalData, characters, length);
@@ -278,6 +314,11 @@ int Lexer::lex(void* p1, void* p2)
     int token = 0;
     m_terminator = false;
 
+    if (UNLIKELY(m_skippedLineCount)) {
+        m_lineNumber += m_skippedLineCount;
+        m_skippedLineCount = 0;
+    }
+
 start:
     while (isWhiteSpace(m_current))
         shift1();
@@ -513,7 +554,8 @@ start:
             break;
         case '{':
             lvalp->intValue = currentOffset();
-            shift1();
+            if (!skipFunctionBody(lvalp->intValue))
+                shift1();
             token = OPENBRACE;
             break;
         case '}':
@@ -1021,8 +1063,15 @@ void Lexer::clear()
 
 SourceCode Lexer::sourceCode(int openBrace, int closeBrace, int firstLine)
 {
-    if (m_codeWithoutBOMs.isEmpty())
+    if (m_codeWithoutBOMs.isEmpty()) {
+        // Only called once the whole function body has been reduced, so it is known to be valid.
+        SourceProvider* provider = m_source->provider();
+        if (!provider->functionBodyExtent(openBrace)) {
+            FunctionBodyExtent extent = { closeBrace, countLineTerminators(m_codeStart + openBrace, m_codeStart + closeBrace) };
+            provider->addFunctionBodyExtent(openBrace, extent);
+        }
         return SourceCode(m_source->provider(), openBrace, closeBrace + 1, firstLine);
+    }
 
     const UChar* data = m_source->provider()->data();
 
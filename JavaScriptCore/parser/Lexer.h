@@ -75,6 +75,7 @@ namespace JSC {
         void record16(UChar);
 
         void copyCodeWithoutBOMs();
+        bool skipFunctionBody(int openBrace);
 
         int currentOffset() const;
         const UChar* currentCharacter() const;
@@ -86,6 +87,7 @@ namespace JSC {
         static const size_t initialReadBufferCapacity = 32;
 
         int m_lineNumber;
+        int m_skippedLineCount;
 
         Vector<char> m_buffer8;
         Vector<UChar> m_buffer16;
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "ParsedProgramCache.h"
+
+#include "Nodes.h"
+#include <string.h>
+#include <wtf/StringHashFunctions.h>
+
+namespace JSC {
+
+// Short scripts are cheap to parse and mostly unique to a page.
+static const int minimumCachedSourceLength = 1024;
+static const size_t maximumCachedSourceLength = 1024 * 1024;
+static const size_t maximumCachedPrograms = 32;
+
+ParsedProgramCache::ParsedProgramCache()
+    : m_cachedSourceLength(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+ParsedProgramCache::~ParsedProgramCache()
+{
+}
+
+bool ParsedProgramCache::isCacheable(const SourceCode& source)
+{
+    return source.length() >= minimumCachedSourceLength && static_cast<size_t>(source.length()) <= maximumCachedSourceLength / 4;
+}
+
+unsigned ParsedProgramCache::hash(const SourceCode& source)
+{
+    return WTF::stringHash(source.data(), source.length());
+}
+
+SourceCode ParsedProgramCache::copySource(const SourceCode& source)
+{
+    return makeSource(UString(source.data(), source.length()), source.provider()->url(), source.firstLine());
+}
+
+static bool sourcesMatch(const SourceCode& a, const SourceCode& b)
+{
+    if (a.provider() == b.provider())
+        return a.startOffset() == b.startOffset() && a.endOffset() == b.endOffset() && a.firstLine() == b.firstLine();
+    // The URL and line numbers are baked into the tree, so the same text from another URL or starting on
+    // a different line doesn't match.
+    return a.length() == b.length() && a.firstLine() == b.firstLine() && a.provider()->url() == b.provider()->url()
+        && !memcmp(a.data(), b.data(), a.length() * sizeof(UChar));
+}
+
+PassRefPtr<ProgramNode> ParsedProgramCache::get(const SourceCode& source, unsigned hash)
+{
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i].hash != hash || !sourcesMatch(m_entries[i].source, source))
+            continue;
+        ++m_hits;
+        RefPtr<ProgramNode> program = m_entries[i].program;
+        if (i) {
+            Entry entry = m_entries[i];
+            m_entries.remove(i);
+            m_entries.prepend(entry);
+        }
+        return program.release();
+    }
+    ++m_misses;
+    return 0;
+}
+
+void ParsedProgramCache::add(const SourceCode& source, unsigned hash, PassRefPtr<ProgramNode> program)
+{
+    ASSERT(isCacheable(source));
+    ASSERT(program->data());
+
+    Entry entry;
+    entry.hash = hash;
+    entry.source = source;
+    entry.program = program;
+    m_entries.prepend(entry);
+    m_cachedSourceLength += source.length();
+
+    while (m_entries.size() > maximumCachedPrograms || m_cachedSourceLength > maximumCachedSourceLength) {
+        m_cachedSourceLength -= m_entries.last().source.length();
+        m_entries.removeLast();
+    }
+}
+
+void ParsedProgramCache::clear()
+{
+    m_entries.clear();
+    m_cachedSourceLength = 0;
+}
+
+} // namespace JSC
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ParsedProgramCache_h
+#define ParsedProgramCache_h
+
+#include "SourceCode.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    class ProgramNode;
+
+    // Keeps the syntax trees of recently compiled programs, keyed by their URL
+    // and a hash of their source text, so that a script loaded again (typically
+    // the same library on every page of a site) skips lexing and parsing.
+    // Bytecode is still generated per global object, since CodeBlocks are
+    // bound to it. Trees hold Identifiers, so a cache is only valid for the
+    // JSGlobalData that owns it.
+    //
+    // Cached trees are parsed from a copy of the source made by copySource(),
+    // so they never keep a loader's provider (and the resource behind it)
+    // alive. Programs compiled from a cached tree adopt its source.
+    class ParsedProgramCache : public Noncopyable {
+    public:
+        ParsedProgramCache();
+        ~ParsedProgramCache();
+
+        static bool isCacheable(const SourceCode&);
+        static unsigned hash(const SourceCode&);
+        static SourceCode copySource(const SourceCode&);
+
+        PassRefPtr<ProgramNode> get(const SourceCode&, unsigned hash);
+        void add(const SourceCode&, unsigned hash, PassRefPtr<ProgramNode>);
+        void clear();
+
+        unsigned hits() const { return m_hits; }
+        unsigned misses() const { return m_misses; }
+
+    private:
+        struct Entry {
+            unsigned hash;
+            SourceCode source;
+            RefPtr<ProgramNode> program;
+        };
+
+        // Most recently used first.
+        Vector<Entry> m_entries;
+        size_t m_cachedSourceLength;
+        unsigned m_hits;
+        unsigned m_misses;
+    };
+
+} // namespace JSC
+
+#endif // ParsedProgramCache_h
@@ -30,12 +30,18 @@
 #define SourceProvider_h
 
 #include "UString.h"
+#include <wtf/HashMap.h>
 #include <wtf/RefCounted.h>
 
 namespace JSC {
 
     enum SourceBOMPresence { SourceHasNoBOMs, SourceCouldHaveBOMs };
 
+    struct FunctionBodyExtent {
+        int closeBrace;
+        int lineCount;
+    };
+
     class SourceProvider : public RefCounted<SourceProvider> {
     public:
         SourceProvider(const UString& url, SourceBOMPresence hasBOMs = SourceCouldHaveBOMs)
@@ -54,9 +60,20 @@ namespace JSC {
 
         SourceBOMPresence hasBOMs() const { return m_hasBOMs; }
 
+        // Function bodies in this source that have already been parsed without
+        // error, keyed by the offset of their open brace. When an enclosing
+        // function is reparsed for compilation, the lexer skips over them.
+        const FunctionBodyExtent* functionBodyExtent(int openBrace) const
+        {
+            HashMap<int, FunctionBodyExtent>::const_iterator it = m_functionBodyExtents.find(openBrace);
+            return it == m_functionBodyExtents.end() ? 0 : &it->second;
+        }
+        void addFunctionBodyExtent(int openBrace, const FunctionBodyExtent& extent) { m_functionBodyExtents.set(openBrace, extent); }
+
     private:
         UString m_url;
         SourceBOMPresence m_hasBOMs;
+        HashMap<int, FunctionBodyExtent> m_functionBodyExtents;
     };
 
     class UStringSourceProvider : public SourceProvider {
@@ -73,7 +73,7 @@ static inline bool isNumericCompareFunction(ExecState* exec, CallType callType,
     if (callType != CallTypeJS)
         return false;
 
-#if ENABLE(JIT)
+#if ENABLE(JIT) && !ENABLE(TIERED_COMPILATION)
     // If the JIT is enabled then we need to preserve the invariant that every
     // function with a CodeBlock also has JIT code.
     callData.js.functionExecutable->jitCode(exec, callData.js.scopeChain);
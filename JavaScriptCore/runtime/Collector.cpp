@@ -40,6 +40,7 @@
 #include <limits.h>
 #include <setjmp.h>
 #include <stdlib.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/FastMalloc.h>
 #include <wtf/HashCountedSet.h>
 #include <wtf/UnusedParam.h>
@@ -105,6 +106,27 @@ namespace JSC {
 const size_t GROWTH_FACTOR = 2;
 const size_t LOW_WATER_FACTOR = 4;
 const size_t ALLOCATIONS_PER_COLLECTION = 3600;
+#if ENABLE(JSC_GENERATIONAL_GC)
+// Old cells are only reclaimed by a full collection.
+const size_t NURSERY_COLLECTIONS_PER_FULL_COLLECTION = 8;
+#endif
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+const double DEFAULT_INCREMENTAL_MARKING_BUDGET = 5; // milliseconds
+// Marking starts once allocation has passed this fraction of the blocks, so
+// the rest of the heap is left to allocate from while marking.
+const size_t INCREMENTAL_MARKING_START_NUMERATOR = 3;
+const size_t INCREMENTAL_MARKING_START_DENOMINATOR = 4;
+const size_t INCREMENTAL_MARKING_MIN_BLOCKS = 4;
+#endif
+// Free cells keep a valid JSCell header, since conservative marking may find
+// them, so the free list is linked through the memory just past it.
+COMPILE_ASSERT(sizeof(JSCell) + sizeof(CollectorCell*) <= CELL_SIZE, free_list_link_fits_in_cell);
+
+static inline CollectorCell*& nextFreeCell(CollectorCell* cell)
+{
+    return *reinterpret_cast<CollectorCell**>(reinterpret_cast<char*>(cell) + sizeof(JSCell));
+}
+
 // This value has to be a macro to be used in max() without introducing
 // a PIC branch in Mach-O binaries, see <rdar://problem/5971391>.
 #define MIN_ARRAY_SIZE (static_cast<size_t>(14))
@@ -146,6 +168,9 @@ Heap::Heap(JSGlobalData* globalData)
     , m_currentThreadRegistrar(0)
 #endif
     , m_globalData(globalData)
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    , m_incrementalMarkingBudget(DEFAULT_INCREMENTAL_MARKING_BUDGET)
+#endif
 {
     ASSERT(globalData);
     
@@ -270,6 +295,9 @@ NEVER_INLINE CollectorBlock* Heap::allocateBlock()
     CollectorBlock* block = reinterpret_cast<CollectorBlock*>(address);
     block->heap = this;
     clearMarkBits(block);
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    block->live = block->marked;
+#endif
 
     Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
     for (size_t i = 0; i < HeapConstants::cellsPerBlock; ++i)
@@ -336,6 +364,12 @@ void Heap::freeBlocks()
 {
     ProtectCountSet protectedValuesCopy = m_protectedValues;
 
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    if (m_heap.isMarkingIncrementally) {
+        m_globalData->markStack.drain();
+        m_heap.isMarkingIncrementally = false;
+    }
+#endif
     clearMarkBits();
     ProtectCountSet::iterator protectedValuesEnd = protectedValuesCopy.end();
     for (ProtectCountSet::iterator it = protectedValuesCopy.begin(); it != protectedValuesEnd; ++it)
@@ -379,7 +413,13 @@ void Heap::recordExtraCost(size_t cost)
         // If the last iteration through the heap deallocated blocks, we need
         // to clean up remaining garbage before marking. Otherwise, the conservative
         // marking mechanism might follow a pointer to unmapped memory.
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        // While marking incrementally, unmarked cells are not necessarily
+        // garbage; startIncrementalMarking() already swept.
+        if (m_heap.didShrink && !m_heap.isMarkingIncrementally)
+#else
         if (m_heap.didShrink)
+#endif
             sweep();
         reset();
     }
@@ -388,7 +428,6 @@ void Heap::recordExtraCost(size_t cost)
 
 void* Heap::allocate(size_t s)
 {
-    typedef HeapConstants::Block Block;
     typedef HeapConstants::Cell Cell;
     
     ASSERT(JSLock::lockCount() > 0);
@@ -404,25 +443,34 @@ void* Heap::allocate(size_t s)
 
 allocate:
 
-    // Fast case: find the next garbage cell and recycle it.
+    // Fast case: take the next cell off the current block's free list.
 
-    do {
-        ASSERT(m_heap.nextBlock < m_heap.usedBlocks);
-        Block* block = reinterpret_cast<Block*>(m_heap.blocks[m_heap.nextBlock]);
-        do {
-            ASSERT(m_heap.nextCell < HeapConstants::cellsPerBlock);
-            if (!block->marked.get(m_heap.nextCell)) { // Always false for the last cell in the block
-                Cell* cell = block->cells + m_heap.nextCell;
+    if (Cell* cell = m_heap.freeList) {
+        m_heap.freeList = nextFreeCell(cell);
+        return cell;
+    }
 
-                m_heap.operationInProgress = Allocation;
-                JSCell* imp = reinterpret_cast<JSCell*>(cell);
-                imp->~JSCell();
-                m_heap.operationInProgress = NoOperation;
+    // Sweep the following blocks until one of them has a free cell.
 
-                ++m_heap.nextCell;
+    do {
+        ASSERT(m_heap.nextBlock < m_heap.usedBlocks);
+        if (!m_heap.nextCell) {
+            sweepBlock(m_heap.nextBlock);
+            if (Cell* cell = m_heap.freeList) {
+                m_heap.freeList = nextFreeCell(cell);
                 return cell;
             }
-        } while (++m_heap.nextCell != HeapConstants::cellsPerBlock);
+        }
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        // Mark one slice each time allocation moves on to a new block.
+        if (m_heap.isMarkingIncrementally) {
+            if (markIncrementally()) {
+                reset();
+                goto allocate;
+            }
+        } else if (shouldStartIncrementalMarking())
+            startIncrementalMarking();
+#endif
         m_heap.nextCell = 0;
     } while (++m_heap.nextBlock != m_heap.usedBlocks);
 
@@ -432,6 +480,42 @@ allocate:
     goto allocate;
 }
 
+// Destroys the dead cells of a block and threads them onto the free list,
+// so the allocator only pays for the blocks it actually allocates from.
+void Heap::sweepBlock(size_t blockIndex)
+{
+    typedef HeapConstants::Cell Cell;
+
+    ASSERT(!m_heap.freeList);
+    CollectorBlock* block = m_heap.blocks[blockIndex];
+    Structure* dummyMarkableCellStructure = m_globalData->dummyMarkableCellStructure.get();
+
+    m_heap.operationInProgress = Allocation;
+    Cell* freeList = 0;
+    // Walk backwards so that cells are handed out in address order. The
+    // last cell is the sentinel, which is always marked.
+    for (size_t i = HeapConstants::cellsPerBlock - 1; i-- > 0; ) {
+        if (block->marked.get(i))
+            continue;
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        // Cells that survived the last collection are not free just
+        // because marking has not reached them yet.
+        if (m_heap.isMarkingIncrementally && block->live.get(i))
+            continue;
+#endif
+        Cell* cell = block->cells + i;
+        JSCell* imp = reinterpret_cast<JSCell*>(cell);
+        imp->~JSCell();
+        new (imp) JSCell(dummyMarkableCellStructure);
+        nextFreeCell(cell) = freeList;
+        freeList = cell;
+    }
+    m_heap.operationInProgress = NoOperation;
+
+    m_heap.freeList = freeList;
+    m_heap.nextCell = HeapConstants::cellsPerBlock - 1;
+}
+
 void Heap::resizeBlocks()
 {
     m_heap.didShrink = false;
@@ -786,6 +870,9 @@ void Heap::markConservatively(MarkStack& markStack, void* start, void* end)
                 if (blocks[block] != blockAddr)
                     continue;
                 markStack.append(reinterpret_cast<JSCell*>(xAsBits));
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+                if (!m_heap.isMarkingIncrementally)
+#endif
                 markStack.drain();
             }
         }
@@ -1025,6 +1112,9 @@ void Heap::markProtectedObjects(MarkStack& markStack)
     ProtectCountSet::iterator end = m_protectedValues.end();
     for (ProtectCountSet::iterator it = m_protectedValues.begin(); it != end; ++it) {
         markStack.append(it->first);
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        if (!m_heap.isMarkingIncrementally)
+#endif
         markStack.drain();
     }
 }
@@ -1040,6 +1130,10 @@ void Heap::clearMarkBits(CollectorBlock* block)
     // allocate assumes that the last cell in every block is marked.
     block->marked.clearAll();
     block->marked.set(HeapConstants::cellsPerBlock - 1);
+#if ENABLE(JSC_GENERATIONAL_GC)
+    block->remembered.clearAll();
+    block->dirty = 0;
+#endif
 }
 
 size_t Heap::markedCells(size_t startBlock, size_t startCell) const
@@ -1090,26 +1184,43 @@ void Heap::sweep()
     m_heap.operationInProgress = NoOperation;
 }
 
-void Heap::markRoots()
+#if ENABLE(JSC_GENERATIONAL_GC)
+bool Heap::shouldCollectNursery() const
 {
-#ifndef NDEBUG
-    if (m_globalData->isSharedInstance) {
-        ASSERT(JSLock::lockCount() > 0);
-        ASSERT(JSLock::currentThreadIsHoldingLock());
-    }
+    // If the last iteration through the heap deallocated blocks, old cells
+    // may point into unmapped memory, so only a full collection is safe.
+    return !m_heap.didShrink && m_heap.nurseryCollectionsSinceFull < NURSERY_COLLECTIONS_PER_FULL_COLLECTION;
+}
 #endif
 
-    ASSERT(m_heap.operationInProgress == NoOperation);
-    if (m_heap.operationInProgress != NoOperation)
-        CRASH();
-
-    m_heap.operationInProgress = Collection;
-
-    MarkStack& markStack = m_globalData->markStack;
-
-    // Reset mark bits.
-    clearMarkBits();
+#if ENABLE(JSC_WRITE_BARRIER)
+void Heap::markRememberedCells(MarkStack& markStack)
+{
+    for (size_t i = 0; i < m_heap.usedBlocks; ++i) {
+        CollectorBlock* block = m_heap.blocks[i];
+        // A dirty block may have had a new cell stored into any of its marked
+        // cells, so all of them are visited again. Visiting a cell remembers
+        // it again if it still needs to be, so the set only holds cells whose
+        // children can still change without a barrier.
+        const CollectorBitmap& cells = block->dirty ? block->marked : block->remembered;
+        for (size_t word = 0; word < BITMAP_WORDS; ++word) {
+            uint32_t bits = cells.bits[word];
+            block->remembered.bits[word] = 0;
+            if (!bits)
+                continue;
+            size_t end = std::min((word + 1) << 5, HeapConstants::cellsPerBlock - 1); // Skip the sentinel.
+            for (size_t cell = word << 5; cell < end; ++cell) {
+                if (bits & (1 << (cell & 0x1F)))
+                    markStack.appendMarkedCell(reinterpret_cast<JSCell*>(block->cells + cell));
+            }
+        }
+        block->dirty = 0;
+    }
+}
+#endif
 
+void Heap::markRootSet(MarkStack& markStack)
+{
     // Mark stack roots.
     markStackObjectsConservatively(markStack);
     m_globalData->interpreter->registerFile().markCallFrames(markStack, this);
@@ -1126,6 +1237,45 @@ void Heap::markRoots()
         m_globalData->functionCodeBlockBeingReparsed->markAggregate(markStack);
     if (m_globalData->firstStringifierToMark)
         JSONObject::markStringifiers(markStack, m_globalData->firstStringifierToMark);
+}
+
+void Heap::markRoots(CollectionType collectionType)
+{
+#ifndef NDEBUG
+    if (m_globalData->isSharedInstance) {
+        ASSERT(JSLock::lockCount() > 0);
+        ASSERT(JSLock::currentThreadIsHoldingLock());
+    }
+#endif
+
+    ASSERT(m_heap.operationInProgress == NoOperation);
+    if (m_heap.operationInProgress != NoOperation)
+        CRASH();
+
+    m_heap.operationInProgress = Collection;
+
+    MarkStack& markStack = m_globalData->markStack;
+
+#if ENABLE(JSC_GENERATIONAL_GC)
+    // A nursery collection keeps the mark bits of the last collection, so
+    // marking stops at old cells and only new cells are traced.
+    if (collectionType == NurseryCollection) {
+        markRememberedCells(markStack);
+        ++m_heap.nurseryCollectionsSinceFull;
+        ++m_heap.nurseryCollections;
+    } else {
+        clearMarkBits();
+        m_heap.nurseryCollectionsSinceFull = 0;
+        ++m_heap.fullCollections;
+    }
+#else
+    UNUSED_PARAM(collectionType);
+
+    // Reset mark bits.
+    clearMarkBits();
+#endif
+
+    markRootSet(markStack);
 
     // Mark the small strings cache last, since it will clear itself if nothing
     // else has marked it.
@@ -1139,9 +1289,14 @@ void Heap::markRoots()
 
 size_t Heap::objectCount() const
 {
+    size_t freeCells = 0;
+    for (CollectorCell* cell = m_heap.freeList; cell; cell = nextFreeCell(cell))
+        ++freeCells;
+
     return m_heap.nextBlock * HeapConstants::cellsPerBlock // allocated full blocks
            + m_heap.nextCell // allocated cells in current block
            + markedCells(m_heap.nextBlock, m_heap.nextCell) // marked cells in remainder of m_heap
+           - freeCells // swept cells in current block
            - m_heap.usedBlocks; // 1 cell per block is a dummy sentinel
 }
 
@@ -1149,6 +1304,8 @@ void Heap::addToStatistics(Heap::Statistics& statistics) const
 {
     statistics.size += m_heap.usedBlocks * BLOCK_SIZE;
     statistics.free += m_heap.usedBlocks * BLOCK_SIZE - (objectCount() * HeapConstants::cellSize);
+    statistics.size += m_storageAllocator.capacity();
+    statistics.free += m_storageAllocator.capacity() - m_storageAllocator.size();
 }
 
 Heap::Statistics Heap::statistics() const
@@ -1239,16 +1396,129 @@ bool Heap::isBusy()
     return m_heap.operationInProgress != NoOperation;
 }
 
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+bool Heap::shouldStartIncrementalMarking() const
+{
+    if (m_incrementalMarkingBudget <= 0 || m_heap.usedBlocks < INCREMENTAL_MARKING_MIN_BLOCKS)
+        return false;
+    return (m_heap.nextBlock + 1) * INCREMENTAL_MARKING_START_DENOMINATOR >= m_heap.usedBlocks * INCREMENTAL_MARKING_START_NUMERATOR;
+}
+
+void Heap::startIncrementalMarking()
+{
+    ASSERT(!m_heap.isMarkingIncrementally);
+    double startTime = currentTime();
+
+    // Sweeping needs unmarked cells to be garbage, so it cannot run once
+    // marking has started.
+    if (m_heap.didShrink)
+        sweep();
+
+    ASSERT(m_heap.operationInProgress == NoOperation);
+    m_heap.operationInProgress = Collection;
+
+    // Cells marked by the last collection stay allocated until this cycle
+    // decides whether they are still reachable.
+    for (size_t i = 0; i < m_heap.usedBlocks; ++i) {
+        CollectorBlock* block = m_heap.blocks[i];
+        block->live = block->marked;
+        clearMarkBits(block);
+    }
+    m_heap.isMarkingIncrementally = true;
+    ++m_heap.incrementalMarkingCycles;
+
+    MarkStack& markStack = m_globalData->markStack;
+    markRootSet(markStack);
+    markStack.drainUntil(startTime + m_incrementalMarkingBudget / 1000);
+
+    m_heap.operationInProgress = NoOperation;
+    recordPause(startTime);
+}
+
+bool Heap::markIncrementally()
+{
+    ASSERT(m_heap.isMarkingIncrementally);
+    MarkStack& markStack = m_globalData->markStack;
+    if (markStack.isEmpty())
+        return true;
+
+    double startTime = currentTime();
+    ASSERT(m_heap.operationInProgress == NoOperation);
+    m_heap.operationInProgress = Collection;
+    markStack.drainUntil(startTime + m_incrementalMarkingBudget / 1000);
+    m_heap.operationInProgress = NoOperation;
+
+    ++m_heap.incrementalMarkingSlices;
+    recordPause(startTime);
+    return false;
+}
+
+void Heap::finishIncrementalMarking()
+{
+    ASSERT(m_heap.isMarkingIncrementally);
+    ASSERT(m_heap.operationInProgress == NoOperation);
+    m_heap.operationInProgress = Collection;
+
+    // Roots and cells that were written to since marking started may point
+    // to cells marking has not seen, so visit them again.
+    MarkStack& markStack = m_globalData->markStack;
+    markRootSet(markStack);
+    markRememberedCells(markStack);
+    m_globalData->smallStrings.markChildren(markStack);
+    markStack.drain();
+    markStack.compact();
+
+    m_heap.isMarkingIncrementally = false;
+    m_heap.operationInProgress = NoOperation;
+}
+
+void Heap::recordPause(double startTime)
+{
+    double pause = (currentTime() - startTime) * 1000;
+    if (pause > m_heap.maxPause)
+        m_heap.maxPause = pause;
+}
+
+Heap::IncrementalMarkingStatistics Heap::incrementalMarkingStatistics() const
+{
+    IncrementalMarkingStatistics statistics = { m_heap.incrementalMarkingCycles, m_heap.incrementalMarkingSlices, m_heap.maxPause };
+    return statistics;
+}
+#endif
+
 void Heap::reset()
 {
     JAVASCRIPTCORE_GC_BEGIN();
 
+    // Allocation has lazily swept the heap since the last collection, so the
+    // storage of the cells it found dead is back on the free lists.
+    m_storageAllocator.releaseEmptyChunks();
+
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    double startTime = currentTime();
+    if (m_heap.isMarkingIncrementally)
+        finishIncrementalMarking();
+    else
+        markRoots();
+    recordPause(startTime);
+#elif ENABLE(JSC_GENERATIONAL_GC)
+    if (shouldCollectNursery()) {
+        markRoots(NurseryCollection);
+        // If promoted cells fill more than half the heap, the heap would
+        // grow; see whether enough old cells have died first.
+        if (markedCells() > m_heap.usedBlocks * HeapConstants::cellsPerBlock / 2)
+            markRoots(FullCollection);
+    } else
+        markRoots(FullCollection);
+#else
     markRoots();
+#endif
 
     JAVASCRIPTCORE_GC_MARKED();
 
     m_heap.nextCell = 0;
     m_heap.nextBlock = 0;
+    m_heap.freeList = 0;
     m_heap.nextNumber = 0;
     m_heap.extraCost = 0;
 #if ENABLE(JSC_ZOMBIES)
@@ -1266,6 +1536,16 @@ void Heap::collectAllGarbage()
     // If the last iteration through the heap deallocated blocks, we need
     // to clean up remaining garbage before marking. Otherwise, the conservative
     // marking mechanism might follow a pointer to unmapped memory.
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    // Give up on the current cycle. Everything it has found is rediscovered
+    // below, and cells it has not reached yet must survive the sweep.
+    if (m_heap.isMarkingIncrementally) {
+        m_globalData->markStack.drain();
+        for (size_t i = 0; i < m_heap.usedBlocks; ++i)
+            m_heap.blocks[i]->marked.merge(m_heap.blocks[i]->live);
+        m_heap.isMarkingIncrementally = false;
+    }
+#endif
     if (m_heap.didShrink)
         sweep();
 
@@ -1275,9 +1555,11 @@ void Heap::collectAllGarbage()
 
     m_heap.nextCell = 0;
     m_heap.nextBlock = 0;
+    m_heap.freeList = 0;
     m_heap.nextNumber = 0;
     m_heap.extraCost = 0;
     sweep();
+    m_storageAllocator.releaseEmptyChunks();
     resizeBlocks();
 
     JAVASCRIPTCORE_GC_END();
@@ -22,6 +22,7 @@
 #ifndef Collector_h
 #define Collector_h
 
+#include "StorageAllocator.h"
 #include <stddef.h>
 #include <string.h>
 #include <wtf/HashCountedSet.h>
@@ -30,6 +31,7 @@
 #include <wtf/OwnPtr.h>
 #include <wtf/StdLibExtras.h>
 #include <wtf/Threading.h>
+#include <wtf/UnusedParam.h>
 
 #if ENABLE(JSC_MULTIPLE_THREADS)
 #include <pthread.h>
@@ -40,6 +42,7 @@
 namespace JSC {
 
     class CollectorBlock;
+    struct CollectorCell;
     class JSCell;
     class JSGlobalData;
     class JSValue;
@@ -52,7 +55,8 @@ namespace JSC {
 
     struct CollectorHeap {
         size_t nextBlock;
-        size_t nextCell;
+        size_t nextCell; // cellsPerBlock - 1 once the current block has been swept.
+        CollectorCell* freeList; // Swept cells in the current block.
         CollectorBlock** blocks;
         
         void* nextNumber;
@@ -63,6 +67,19 @@ namespace JSC {
         size_t extraCost;
         bool didShrink;
 
+#if ENABLE(JSC_GENERATIONAL_GC)
+        size_t nurseryCollectionsSinceFull;
+        size_t nurseryCollections;
+        size_t fullCollections;
+#endif
+
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        bool isMarkingIncrementally;
+        size_t incrementalMarkingCycles;
+        size_t incrementalMarkingSlices;
+        double maxPause;
+#endif
+
         OperationInProgress operationInProgress;
     };
 
@@ -88,7 +105,10 @@ namespace JSC {
             size_t size;
             size_t free;
         };
-        Statistics statistics() const;
+        Statistics statistics() const; // Includes out-of-line storage.
+
+        // Out-of-line storage owned by cells in this heap.
+        StorageAllocator& storageAllocator() { return m_storageAllocator; }
 
         void protect(JSValue);
         void unprotect(JSValue);
@@ -106,6 +126,35 @@ namespace JSC {
 
         static bool isCellMarked(const JSCell*);
         static void markCell(JSCell*);
+        // Unlike isCellMarked, also true during incremental marking for
+        // cells that survived the previous collection.
+        static bool isCellLive(const JSCell*);
+
+        // Must be called whenever a JSValue is stored into a cell outside of
+        // its constructor. Cells whose class overrides markChildren are
+        // remembered and visited again instead, except for the classes that
+        // call this for their own stores; see MarkStack::markChildren.
+        static void writeBarrier(const JSCell* owner);
+#if ENABLE(JSC_WRITE_BARRIER)
+        static void rememberCell(const JSCell*);
+#endif
+#if ENABLE(JSC_GENERATIONAL_GC)
+        size_t nurseryCollectionCount() const { return m_heap.nurseryCollections; }
+        size_t fullCollectionCount() const { return m_heap.fullCollections; }
+#endif
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        // Each marking slice stops after roughly this many milliseconds; the
+        // final pause is bounded by the roots and barrier-recorded cells
+        // instead. 0 makes every collection stop the world.
+        void setIncrementalMarkingBudget(double milliseconds) { m_incrementalMarkingBudget = milliseconds; }
+
+        struct IncrementalMarkingStatistics {
+            size_t cycles;
+            size_t slices;
+            double maxPause; // Milliseconds, including non-incremental collections.
+        };
+        IncrementalMarkingStatistics incrementalMarkingStatistics() const;
+#endif
 
         void markConservatively(MarkStack&, void* start, void* end);
 
@@ -118,6 +167,8 @@ namespace JSC {
         LiveObjectIterator primaryHeapEnd();
 
     private:
+        enum CollectionType { FullCollection, NurseryCollection };
+
         void reset();
         void sweep();
         static CollectorBlock* cellBlock(const JSCell*);
@@ -142,7 +193,23 @@ namespace JSC {
 
         void addToStatistics(Statistics&) const;
 
-        void markRoots();
+        void sweepBlock(size_t);
+
+        void markRoots(CollectionType = FullCollection);
+        void markRootSet(MarkStack&);
+#if ENABLE(JSC_GENERATIONAL_GC)
+        bool shouldCollectNursery() const;
+#endif
+#if ENABLE(JSC_WRITE_BARRIER)
+        void markRememberedCells(MarkStack&);
+#endif
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        bool shouldStartIncrementalMarking() const;
+        void startIncrementalMarking();
+        bool markIncrementally();
+        void finishIncrementalMarking();
+        void recordPause(double startTime);
+#endif
         void markProtectedObjects(MarkStack&);
         void markCurrentThreadConservatively(MarkStack&);
         void markCurrentThreadConservativelyInternal(MarkStack&);
@@ -169,6 +236,12 @@ namespace JSC {
 #endif
 
         JSGlobalData* m_globalData;
+
+        StorageAllocator m_storageAllocator;
+
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        double m_incrementalMarkingBudget;
+#endif
     };
 
     // tunable parameters
@@ -197,7 +270,17 @@ namespace JSC {
     const size_t SMALL_CELL_SIZE = CELL_SIZE / 2;
     const size_t CELL_MASK = CELL_SIZE - 1;
     const size_t CELL_ALIGN_MASK = ~CELL_MASK;
+#if ENABLE(JSC_WRITE_BARRIER)
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    const size_t COLLECTOR_BITMAP_COUNT = 3; // marked, remembered and live.
+#else
+    const size_t COLLECTOR_BITMAP_COUNT = 2; // marked and remembered.
+#endif
+    // Leave room for the dirty card and for rounding each bitmap up to a word.
+    const size_t CELLS_PER_BLOCK = (BLOCK_SIZE - sizeof(Heap*) - sizeof(uint32_t) * (COLLECTOR_BITMAP_COUNT + 1)) * 8 * CELL_SIZE / (8 * CELL_SIZE + COLLECTOR_BITMAP_COUNT) / CELL_SIZE;
+#else
     const size_t CELLS_PER_BLOCK = (BLOCK_SIZE - sizeof(Heap*)) * 8 * CELL_SIZE / (8 * CELL_SIZE + 1) / CELL_SIZE; // one bitmap byte can represent 8 cells.
+#endif
     
     const size_t BITMAP_SIZE = (CELLS_PER_BLOCK + 7) / 8;
     const size_t BITMAP_WORDS = (BITMAP_SIZE + 3) / sizeof(uint32_t);
@@ -208,6 +291,11 @@ namespace JSC {
         void set(size_t n) { bits[n >> 5] |= (1 << (n & 0x1F)); } 
         void clear(size_t n) { bits[n >> 5] &= ~(1 << (n & 0x1F)); } 
         void clearAll() { memset(bits, 0, sizeof(bits)); }
+        void merge(const CollectorBitmap& other)
+        {
+            for (size_t i = 0; i < BITMAP_WORDS; ++i)
+                bits[i] |= other.bits[i];
+        }
         size_t count(size_t startCell = 0)
         {
             size_t result = 0;
@@ -236,6 +324,17 @@ namespace JSC {
     public:
         CollectorCell cells[CELLS_PER_BLOCK];
         CollectorBitmap marked;
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        // The mark bits of the previous collection while marking is in progress.
+        CollectorBitmap live;
+#endif
+#if ENABLE(JSC_WRITE_BARRIER)
+        // Cells whose children are visited again by every nursery collection
+        // or final marking pause.
+        CollectorBitmap remembered;
+        // Set by the write barrier; the card covers every cell in the block.
+        uint32_t dirty;
+#endif
         Heap* heap;
     };
 
@@ -266,6 +365,33 @@ namespace JSC {
         cellBlock(cell)->marked.set(cellOffset(cell));
     }
 
+    inline bool Heap::isCellLive(const JSCell* cell)
+    {
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        CollectorBlock* block = cellBlock(cell);
+        size_t offset = cellOffset(cell);
+        return block->marked.get(offset) || (block->heap->m_heap.isMarkingIncrementally && block->live.get(offset));
+#else
+        return isCellMarked(cell);
+#endif
+    }
+
+    inline void Heap::writeBarrier(const JSCell* owner)
+    {
+#if ENABLE(JSC_WRITE_BARRIER)
+        cellBlock(owner)->dirty = 1;
+#else
+        UNUSED_PARAM(owner);
+#endif
+    }
+
+#if ENABLE(JSC_WRITE_BARRIER)
+    inline void Heap::rememberCell(const JSCell* cell)
+    {
+        cellBlock(cell)->remembered.set(cellOffset(cell));
+    }
+#endif
+
     inline void Heap::reportExtraMemoryCost(size_t cost)
     {
         if (cost > minExtraCost) 
@@ -29,6 +29,7 @@
 #include "BytecodeGenerator.h"
 #include "CodeBlock.h"
 #include "JIT.h"
+#include "ParsedProgramCache.h"
 #include "Parser.h"
 #include "StringBuilder.h"
 #include "Vector.h"
@@ -93,11 +94,30 @@ JSObject* ProgramExecutable::checkSyntax(ExecState* exec)
 
 JSObject* ProgramExecutable::compile(ExecState* exec, ScopeChainNode* scopeChainNode)
 {
-    int errLine;
-    UString errMsg;
-    RefPtr<ProgramNode> programNode = exec->globalData().parser->parse<ProgramNode>(&exec->globalData(), exec->lexicalGlobalObject()->debugger(), exec, m_source, &errLine, &errMsg);
-    if (!programNode)
-        return Error::create(exec, SyntaxError, errMsg, errLine, m_source.provider()->asID(), m_source.provider()->url());
+    JSGlobalData* globalData = &exec->globalData();
+    Debugger* debugger = exec->lexicalGlobalObject()->debugger();
+
+    // The debugger has to see every parse, so it bypasses the cache.
+    bool cacheable = !debugger && ParsedProgramCache::isCacheable(m_source);
+    unsigned sourceHash = cacheable ? ParsedProgramCache::hash(m_source) : 0;
+
+    RefPtr<ProgramNode> programNode;
+    if (cacheable)
+        programNode = globalData->parsedProgramCache->get(m_source, sourceHash);
+    if (!programNode) {
+        int errLine;
+        UString errMsg;
+        SourceCode source = cacheable ? ParsedProgramCache::copySource(m_source) : m_source;
+        programNode = globalData->parser->parse<ProgramNode>(globalData, debugger, exec, source, &errLine, &errMsg);
+        if (!programNode)
+            return Error::create(exec, SyntaxError, errMsg, errLine, m_source.provider()->asID(), m_source.provider()->url());
+        if (cacheable)
+            globalData->parsedProgramCache->add(source, sourceHash, programNode);
+    }
+    // Nested functions of a cached tree refer to its source, so the program
+    // takes it too, to report the same source ID and URL throughout.
+    if (cacheable)
+        m_source = programNode->source();
     recordParse(programNode->features(), programNode->lineNo(), programNode->lastLine());
 
     ScopeChain scopeChain(scopeChainNode);
@@ -108,7 +128,9 @@ JSObject* ProgramExecutable::compile(ExecState* exec, ScopeChainNode* scopeChain
     OwnPtr<BytecodeGenerator> generator(new BytecodeGenerator(programNode.get(), globalObject->debugger(), scopeChain, &globalObject->symbolTable(), m_programCodeBlock));
     generator->generate();
 
-    programNode->destroyData();
+    // A cached tree keeps its data for the next compile.
+    if (!cacheable)
+        programNode->destroyData();
     return 0;
 }
 
@@ -125,11 +147,20 @@ void FunctionExecutable::compile(ExecState*, ScopeChainNode* scopeChainNode)
     JSGlobalObject* globalObject = scopeChain.globalObject();
 
     ASSERT(!m_codeBlock);
+#if ENABLE(JSC_WRITE_BARRIER)
+    // A collection while the code block is generated marks only part of it.
+    m_isCompiling = true;
+#endif
     m_codeBlock = new FunctionCodeBlock(this, FunctionCode, source().provider(), source().startOffset());
     OwnPtr<BytecodeGenerator> generator(new BytecodeGenerator(body.get(), globalObject->debugger(), scopeChain, m_codeBlock->symbolTable(), m_codeBlock));
     generator->generate();
+#if ENABLE(JSC_WRITE_BARRIER)
+    m_isCompiling = false;
+#endif
+#if !ENABLE(TIERED_COMPILATION)
     m_numParameters = m_codeBlock->m_numParameters;
     ASSERT(m_numParameters);
+#endif
     m_numVariables = m_codeBlock->m_numVars;
 
     body->destroyData();
@@ -142,7 +173,7 @@ void EvalExecutable::generateJITCode(ExecState* exec, ScopeChainNode* scopeChain
     CodeBlock* codeBlock = &bytecode(exec, scopeChainNode);
     m_jitCode = JIT::compile(scopeChainNode->globalData, codeBlock);
 
-#if !ENABLE(OPCODE_SAMPLING)
+#if !ENABLE(OPCODE_SAMPLING) && !ENABLE(TIERED_COMPILATION)
     if (!BytecodeGenerator::dumpsGeneratedCode())
         codeBlock->discardBytecode();
 #endif
@@ -153,7 +184,7 @@ void ProgramExecutable::generateJITCode(ExecState* exec, ScopeChainNode* scopeCh
     CodeBlock* codeBlock = &bytecode(exec, scopeChainNode);
     m_jitCode = JIT::compile(scopeChainNode->globalData, codeBlock);
 
-#if !ENABLE(OPCODE_SAMPLING)
+#if !ENABLE(OPCODE_SAMPLING) && !ENABLE(TIERED_COMPILATION)
     if (!BytecodeGenerator::dumpsGeneratedCode())
         codeBlock->discardBytecode();
 #endif
@@ -164,7 +195,14 @@ void FunctionExecutable::generateJITCode(ExecState* exec, ScopeChainNode* scopeC
     CodeBlock* codeBlock = &bytecode(exec, scopeChainNode);
     m_jitCode = JIT::compile(scopeChainNode->globalData, codeBlock);
 
-#if !ENABLE(OPCODE_SAMPLING)
+#if ENABLE(TIERED_COMPILATION)
+    // The JIT's call trampolines take a parameter count as a sign that the JIT code
+    // exists, so an interpreted function only gets one once it has been compiled.
+    m_numParameters = codeBlock->m_numParameters;
+    ASSERT(m_numParameters);
+#endif
+
+#if !ENABLE(OPCODE_SAMPLING) && !ENABLE(TIERED_COMPILATION)
     if (!BytecodeGenerator::dumpsGeneratedCode())
         codeBlock->discardBytecode();
 #endif
@@ -174,8 +212,12 @@ void FunctionExecutable::generateJITCode(ExecState* exec, ScopeChainNode* scopeC
 
 void FunctionExecutable::markAggregate(MarkStack& markStack)
 {
-    if (m_codeBlock)
+    if (m_codeBlock) {
         m_codeBlock->markAggregate(markStack);
+#if ENABLE(JSC_WRITE_BARRIER)
+        m_codeIsMarked = !m_isCompiling;
+#endif
+    }
 }
 
 ExceptionInfo* FunctionExecutable::reparseExceptionInfo(JSGlobalData* globalData, ScopeChainNode* scopeChainNode, CodeBlock* codeBlock)
@@ -199,7 +241,7 @@ ExceptionInfo* FunctionExecutable::reparseExceptionInfo(JSGlobalData* globalData
 
 #if ENABLE(JIT)
     JITCode newJITCode = JIT::compile(globalData, newCodeBlock.get());
-    ASSERT(newJITCode.size() == generatedJITCode().size());
+    ASSERT(!m_jitCode || newJITCode.size() == m_jitCode.size());
 #endif
 
     globalData->functionCodeBlockBeingReparsed = 0;
@@ -224,7 +266,7 @@ ExceptionInfo* EvalExecutable::reparseExceptionInfo(JSGlobalData* globalData, Sc
 
 #if ENABLE(JIT)
     JITCode newJITCode = JIT::compile(globalData, newCodeBlock.get());
-    ASSERT(newJITCode.size() == generatedJITCode().size());
+    ASSERT(!m_jitCode || newJITCode.size() == m_jitCode.size());
 #endif
 
     return newCodeBlock->extractExceptionInfo();
@@ -235,6 +277,9 @@ void FunctionExecutable::recompile(ExecState*)
     delete m_codeBlock;
     m_codeBlock = 0;
     m_numParameters = NUM_PARAMETERS_NOT_COMPILED;
+#if ENABLE(JSC_WRITE_BARRIER)
+    m_codeIsMarked = false;
+#endif
 #if ENABLE(JIT)
     m_jitCode = JITCode();
 #endif
@@ -69,6 +69,10 @@ namespace JSC {
             return m_jitCode;
         }
 
+#if ENABLE(TIERED_COMPILATION)
+        bool hasJITCode() const { return !!m_jitCode; }
+#endif
+
         ExecutablePool* getExecutablePool()
         {
             return m_jitCode.getExecutablePool();
@@ -290,6 +294,12 @@ namespace JSC {
         void recompile(ExecState*);
         ExceptionInfo* reparseExceptionInfo(JSGlobalData*, ScopeChainNode*, CodeBlock*);
         void markAggregate(MarkStack& markStack);
+#if ENABLE(JSC_WRITE_BARRIER)
+        // Compiling fills in the code block's constants without a write
+        // barrier, so until a collection has marked the finished code block,
+        // the functions that share this executable must be visited again.
+        bool codeMayChange() const { return !m_codeIsMarked; }
+#endif
         static PassRefPtr<FunctionExecutable> fromGlobalCode(const Identifier&, ExecState*, Debugger*, const SourceCode&, int* errLine = 0, UString* errMsg = 0);
 
     private:
@@ -300,6 +310,10 @@ namespace JSC {
             , m_codeBlock(0)
             , m_name(name)
             , m_numVariables(0)
+#if ENABLE(JSC_WRITE_BARRIER)
+            , m_isCompiling(false)
+            , m_codeIsMarked(false)
+#endif
         {
             m_firstLine = firstLine;
             m_lastLine = lastLine;
@@ -312,6 +326,10 @@ namespace JSC {
             , m_codeBlock(0)
             , m_name(name)
             , m_numVariables(0)
+#if ENABLE(JSC_WRITE_BARRIER)
+            , m_isCompiling(false)
+            , m_codeIsMarked(false)
+#endif
         {
             m_firstLine = firstLine;
             m_lastLine = lastLine;
@@ -324,6 +342,10 @@ namespace JSC {
         CodeBlock* m_codeBlock;
         Identifier m_name;
         size_t m_numVariables;
+#if ENABLE(JSC_WRITE_BARRIER)
+        bool m_isCompiling;
+        bool m_codeIsMarked;
+#endif
 
 #if ENABLE(JIT)
     public:
@@ -102,6 +102,14 @@ static inline size_t storageSize(unsigned vectorLength)
     return size;
 }
 
+// Storage that fits the heap's StorageAllocator is paid for by its chunks, which
+// grow with the heap; only larger vectors come from fastMalloc.
+static inline size_t mallocedStorageSize(unsigned vectorLength)
+{
+    size_t size = storageSize(vectorLength);
+    return size > StorageAllocator::maxSize ? size : 0;
+}
+
 static inline unsigned increasedVectorLength(unsigned newLength)
 {
     ASSERT(newLength <= MAX_STORAGE_VECTOR_LENGTH);
@@ -135,7 +143,8 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure)
 {
     unsigned initialCapacity = 0;
 
-    m_storage = static_cast<ArrayStorage*>(fastZeroedMalloc(storageSize(initialCapacity)));
+    m_storage = static_cast<ArrayStorage*>(Heap::heap(this)->storageAllocator().allocate(storageSize(initialCapacity)));
+    memset(m_storage, 0, storageSize(initialCapacity));
     m_vectorLength = initialCapacity;
 
     checkConsistency();
@@ -146,7 +155,7 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, unsigned initialLength)
 {
     unsigned initialCapacity = min(initialLength, MIN_SPARSE_ARRAY_INDEX);
 
-    m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialCapacity)));
+    m_storage = static_cast<ArrayStorage*>(Heap::heap(this)->storageAllocator().allocate(storageSize(initialCapacity)));
     m_storage->m_length = initialLength;
     m_vectorLength = initialCapacity;
     m_storage->m_numValuesInVector = 0;
@@ -160,7 +169,7 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, unsigned initialLength)
 
     checkConsistency();
 
-    Heap::heap(this)->reportExtraMemoryCost(initialCapacity * sizeof(JSValue));
+    Heap::heap(this)->reportExtraMemoryCost(mallocedStorageSize(initialCapacity));
 }
 
 JSArray::JSArray(NonNullPassRefPtr<Structure> structure, const ArgList& list)
@@ -168,7 +177,7 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, const ArgList& list)
 {
     unsigned initialCapacity = list.size();
 
-    m_storage = static_cast<ArrayStorage*>(fastMalloc(storageSize(initialCapacity)));
+    m_storage = static_cast<ArrayStorage*>(Heap::heap(this)->storageAllocator().allocate(storageSize(initialCapacity)));
     m_storage->m_length = initialCapacity;
     m_vectorLength = initialCapacity;
     m_storage->m_numValuesInVector = initialCapacity;
@@ -183,16 +192,18 @@ JSArray::JSArray(NonNullPassRefPtr<Structure> structure, const ArgList& list)
 
     checkConsistency();
 
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(initialCapacity));
+    Heap::heap(this)->reportExtraMemoryCost(mallocedStorageSize(initialCapacity));
 }
 
 JSArray::~JSArray()
 {
     ASSERT(vptr() == JSGlobalData::jsArrayVPtr);
+    if (!m_storage)
+        return;
     checkConsistency(DestructorConsistencyCheck);
 
     delete m_storage->m_sparseValueMap;
-    fastFree(m_storage);
+    Heap::heap(this)->storageAllocator().deallocate(m_storage, storageSize(m_vectorLength));
 }
 
 bool JSArray::getOwnPropertySlot(ExecState* exec, unsigned i, PropertySlot& slot)
@@ -296,6 +307,7 @@ void JSArray::put(ExecState* exec, const Identifier& propertyName, JSValue value
 void JSArray::put(ExecState* exec, unsigned i, JSValue value)
 {
     checkConsistency();
+    Heap::writeBarrier(this);
 
     unsigned length = m_storage->m_length;
     if (i >= length && i <= MAX_ARRAY_INDEX) {
@@ -388,7 +400,8 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
         }
     }
 
-    if (!tryFastRealloc(storage, storageSize(newVectorLength)).getValue(storage)) {
+    storage = static_cast<ArrayStorage*>(Heap::heap(this)->storageAllocator().tryReallocate(storage, storageSize(m_vectorLength), storageSize(newVectorLength)));
+    if (!storage) {
         throwOutOfMemoryError(exec);
         return;
     }
@@ -416,7 +429,7 @@ NEVER_INLINE void JSArray::putSlowCase(ExecState* exec, unsigned i, JSValue valu
 
     checkConsistency();
 
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(newVectorLength) - storageSize(vectorLength));
+    Heap::heap(this)->reportExtraMemoryCost(mallocedStorageSize(newVectorLength) - mallocedStorageSize(vectorLength));
 }
 
 bool JSArray::deleteProperty(ExecState* exec, const Identifier& propertyName)
@@ -507,7 +520,8 @@ bool JSArray::increaseVectorLength(unsigned newLength)
     ASSERT(newLength <= MAX_STORAGE_VECTOR_INDEX);
     unsigned newVectorLength = increasedVectorLength(newLength);
 
-    if (!tryFastRealloc(storage, storageSize(newVectorLength)).getValue(storage))
+    storage = static_cast<ArrayStorage*>(Heap::heap(this)->storageAllocator().tryReallocate(storage, storageSize(vectorLength), storageSize(newVectorLength)));
+    if (!storage)
         return false;
 
     m_vectorLength = newVectorLength;
@@ -517,7 +531,7 @@ bool JSArray::increaseVectorLength(unsigned newLength)
 
     m_storage = storage;
 
-    Heap::heap(this)->reportExtraMemoryCost(storageSize(newVectorLength) - storageSize(vectorLength));
+    Heap::heap(this)->reportExtraMemoryCost(mallocedStorageSize(newVectorLength) - mallocedStorageSize(vectorLength));
 
     return true;
 }
@@ -603,6 +617,7 @@ JSValue JSArray::pop()
 void JSArray::push(ExecState* exec, JSValue value)
 {
     checkConsistency();
+    Heap::writeBarrier(this);
 
     if (m_storage->m_length < m_vectorLength) {
         m_storage->m_vector[m_storage->m_length] = value;
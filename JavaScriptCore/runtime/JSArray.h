@@ -23,6 +23,10 @@
 
 #include "JSObject.h"
 
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+#include <wtf/CurrentTime.h>
+#endif
+
 namespace JSC {
 
     typedef HashMap<unsigned, JSValue> SparseArrayValueMap;
@@ -38,6 +42,7 @@ namespace JSC {
 
     class JSArray : public JSObject {
         friend class JIT;
+        friend class JSGlobalData;
         friend class Walker;
 
     public:
@@ -74,6 +79,7 @@ namespace JSC {
         void setIndex(unsigned i, JSValue v)
         {
             ASSERT(canSetIndex(i));
+            Heap::writeBarrier(this);
             JSValue& x = m_storage->m_vector[i];
             if (!x) {
                 ++m_storage->m_numValuesInVector;
@@ -105,6 +111,16 @@ namespace JSC {
         void setLazyCreationData(void*);
 
     private:
+        // The array built by JSGlobalData::storeVPtrs() lives outside the collector's
+        // blocks, so it has no heap to allocate storage from.
+        enum VPtrStealingHackType { VPtrStealingHack };
+        JSArray(VPtrStealingHackType)
+            : JSObject(createStructure(jsNull()))
+            , m_vectorLength(0)
+            , m_storage(0)
+        {
+        }
+
         virtual const ClassInfo* classInfo() const { return &info; }
 
         bool getOwnPropertySlotSlowCase(ExecState*, unsigned propertyName, PropertySlot&);
@@ -159,6 +175,17 @@ namespace JSC {
     inline void MarkStack::markChildren(JSCell* cell)
     {
         ASSERT(Heap::isCellMarked(cell));
+#if ENABLE(JSC_WRITE_BARRIER)
+        // Custom markChildren implementations can reach cells through
+        // references the write barrier never sees, so revisit them. Arrays and
+        // getter/setter pairs barrier their own stores, and functions remember
+        // themselves only while their code can still change. Subclasses are
+        // not exempt, since they may mark more.
+        if (cell->structure()->typeInfo().overridesMarkChildren()
+                && cell->vptr() != m_jsArrayVPtr && cell->vptr() != m_jsFunctionVPtr
+                && cell->structure()->typeInfo().type() != GetterSetterType)
+            Heap::rememberCell(cell);
+#endif
         if (!cell->structure()->typeInfo().overridesMarkChildren()) {
 #ifdef NDEBUG
             asObject(cell)->markChildrenDirect(*this);
@@ -220,6 +247,35 @@ namespace JSC {
                 markChildren(m_values.removeLast());
         }
     }
+
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    inline bool MarkStack::drainUntil(double deadline)
+    {
+        static const unsigned cellsBetweenDeadlineChecks = 128;
+        unsigned cellsUntilDeadlineCheck = cellsBetweenDeadlineChecks;
+        while (!isEmpty()) {
+            // Mark sets point into storage the mutator may free or resize, so
+            // they are always finished before returning.
+            while (!m_markSets.isEmpty()) {
+                MarkSet& current = m_markSets.last();
+                JSValue value = *current.m_values++;
+                if (current.m_values == current.m_end)
+                    m_markSets.removeLast();
+                if (value && value.isCell())
+                    append(value.asCell());
+            }
+            if (m_values.isEmpty())
+                break;
+            markChildren(m_values.removeLast());
+            if (!--cellsUntilDeadlineCheck) {
+                if (m_markSets.isEmpty() && WTF::currentTime() >= deadline)
+                    return isEmpty();
+                cellsUntilDeadlineCheck = cellsBetweenDeadlineChecks;
+            }
+        }
+        return true;
+    }
+#endif
     
 } // namespace JSC
 
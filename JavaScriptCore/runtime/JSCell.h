@@ -336,6 +336,15 @@ namespace JSC {
             m_values.append(cell);
     }
 
+#if ENABLE(JSC_WRITE_BARRIER)
+    inline void MarkStack::appendMarkedCell(JSCell* cell)
+    {
+        ASSERT(Heap::isCellMarked(cell));
+        if (cell->structure()->typeInfo().type() >= CompoundType)
+            m_values.append(cell);
+    }
+#endif
+
     ALWAYS_INLINE void MarkStack::append(JSValue value)
     {
         ASSERT(value);
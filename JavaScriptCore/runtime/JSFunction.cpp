@@ -102,6 +102,10 @@ void JSFunction::markChildren(MarkStack& markStack)
     if (!isHostFunction()) {
         jsExecutable()->markAggregate(markStack);
         scopeChain().markAggregate(markStack);
+#if ENABLE(JSC_WRITE_BARRIER)
+        if (jsExecutable()->codeMayChange())
+            Heap::rememberCell(this);
+#endif
     }
 }
 
@@ -47,7 +47,9 @@
 #include "JSStaticScopeObject.h"
 #include "Lexer.h"
 #include "Lookup.h"
+#include "MegamorphicCache.h"
 #include "Nodes.h"
+#include "ParsedProgramCache.h"
 #include "Parser.h"
 
 #if ENABLE(JSC_MULTIPLE_THREADS)
@@ -82,7 +84,7 @@ void JSGlobalData::storeVPtrs()
     void* storage = &cell;
 
     COMPILE_ASSERT(sizeof(JSArray) <= sizeof(CollectorCell), sizeof_JSArray_must_be_less_than_CollectorCell);
-    JSCell* jsArray = new (storage) JSArray(JSArray::createStructure(jsNull()));
+    JSCell* jsArray = new (storage) JSArray(JSArray::VPtrStealingHack);
     JSGlobalData::jsArrayVPtr = jsArray->vptr();
     jsArray->~JSCell();
 
@@ -131,9 +133,11 @@ JSGlobalData::JSGlobalData(bool isShared)
     , emptyList(new MarkedArgumentBuffer)
     , lexer(new Lexer(this))
     , parser(new Parser)
+    , parsedProgramCache(new ParsedProgramCache)
     , interpreter(new Interpreter)
 #if ENABLE(JIT)
     , jitStubs(this)
+    , megamorphicCache(new MegamorphicCache)
 #endif
     , heap(this)
     , initializingLazyNumericCompareFunction(false)
@@ -141,7 +145,7 @@ JSGlobalData::JSGlobalData(bool isShared)
     , dynamicGlobalObject(0)
     , functionCodeBlockBeingReparsed(0)
     , firstStringifierToMark(0)
-    , markStack(jsArrayVPtr)
+    , markStack(jsArrayVPtr, jsFunctionVPtr)
     , cachedUTCOffset(NaN)
     , weakRandom(static_cast<int>(currentTime()))
 #ifndef NDEBUG
@@ -163,6 +167,10 @@ JSGlobalData::~JSGlobalData()
     interpreter = 0;
 #endif
 
+#if ENABLE(JIT)
+    delete megamorphicCache;
+#endif
+
     arrayTable->deleteTable();
     dateTable->deleteTable();
     jsonTable->deleteTable();
@@ -181,6 +189,7 @@ JSGlobalData::~JSGlobalData()
     fastDelete(const_cast<HashTable*>(regExpConstructorTable));
     fastDelete(const_cast<HashTable*>(stringTable));
 
+    delete parsedProgramCache;
     delete parser;
     delete lexer;
 
@@ -55,6 +55,8 @@ namespace JSC {
     class JSGlobalObject;
     class JSObject;
     class Lexer;
+    class MegamorphicCache;
+    class ParsedProgramCache;
     class Parser;
     class Stringifier;
     class Structure;
@@ -148,9 +150,11 @@ namespace JSC {
 
         Lexer* lexer;
         Parser* parser;
+        ParsedProgramCache* parsedProgramCache;
         Interpreter* interpreter;
 #if ENABLE(JIT)
         JITThunks jitStubs;
+        MegamorphicCache* megamorphicCache;
 #endif
         TimeoutChecker timeoutChecker;
         Heap heap;
@@ -181,7 +181,11 @@ namespace JSC {
 
         // Fast access to known property offsets.
         JSValue getDirectOffset(size_t offset) const { return JSValue::decode(propertyStorage()[offset]); }
-        void putDirectOffset(size_t offset, JSValue value) { propertyStorage()[offset] = JSValue::encode(value); }
+        void putDirectOffset(size_t offset, JSValue value)
+        {
+            propertyStorage()[offset] = JSValue::encode(value);
+            Heap::writeBarrier(this);
+        }
 
         void fillGetterPropertySlot(PropertySlot&, JSValue* location);
 
@@ -221,6 +225,7 @@ namespace JSC {
         {
             ASSERT(index < m_structure->anonymousSlotCount());
             *locationForOffset(index) = value;
+            Heap::writeBarrier(this);
         }
         JSValue getAnonymousValue(unsigned index) const
         {
@@ -297,7 +302,7 @@ inline JSObject::~JSObject()
 {
     ASSERT(m_structure);
     if (!isUsingInlineStorage())
-        delete [] m_externalStorage;
+        Heap::heap(this)->storageAllocator().deallocate(m_externalStorage, m_structure->propertyStorageCapacity() * sizeof(EncodedJSValue));
     m_structure->deref();
 }
 
@@ -317,6 +322,8 @@ inline void JSObject::setStructure(NonNullPassRefPtr<Structure> structure)
 {
     m_structure->deref();
     m_structure = structure.releaseRef(); // ~JSObject balances this ref()
+    // The new Structure may have a different prototype.
+    Heap::writeBarrier(this);
 }
 
 inline Structure* JSObject::inheritorID()
@@ -663,13 +670,14 @@ ALWAYS_INLINE void JSObject::allocatePropertyStorageInline(size_t oldSize, size_
     bool wasInline = (oldSize == JSObject::inlineStorageCapacity);
 
     PropertyStorage oldPropertyStorage = (wasInline ? m_inlineStorage : m_externalStorage);
-    PropertyStorage newPropertyStorage = new EncodedJSValue[newSize];
+    StorageAllocator& storageAllocator = Heap::heap(this)->storageAllocator();
+    PropertyStorage newPropertyStorage = static_cast<PropertyStorage>(storageAllocator.allocate(newSize * sizeof(EncodedJSValue)));
 
     for (unsigned i = 0; i < oldSize; ++i)
        newPropertyStorage[i] = oldPropertyStorage[i];
 
     if (!wasInline)
-        delete [] oldPropertyStorage;
+        storageAllocator.deallocate(oldPropertyStorage, oldSize * sizeof(EncodedJSValue));
 
     m_externalStorage = newPropertyStorage;
 }
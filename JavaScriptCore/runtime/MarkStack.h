@@ -38,8 +38,9 @@ namespace JSC {
     
     class MarkStack : Noncopyable {
     public:
-        MarkStack(void* jsArrayVPtr)
+        MarkStack(void* jsArrayVPtr, void* jsFunctionVPtr)
             : m_jsArrayVPtr(jsArrayVPtr)
+            , m_jsFunctionVPtr(jsFunctionVPtr)
 #ifndef NDEBUG
             , m_isCheckingForDefaultMarkViolation(false)
 #endif
@@ -48,6 +49,10 @@ namespace JSC {
 
         ALWAYS_INLINE void append(JSValue);
         void append(JSCell*);
+#if ENABLE(JSC_WRITE_BARRIER)
+        // Visits the children of a cell that is already marked.
+        void appendMarkedCell(JSCell*);
+#endif
         
         ALWAYS_INLINE void appendValues(Register* values, size_t count, MarkSetProperties properties = NoNullValues)
         {
@@ -61,8 +66,14 @@ namespace JSC {
         }
 
         inline void drain();
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+        // Returns true if the stack was emptied before the deadline passed.
+        inline bool drainUntil(double deadline);
+#endif
         void compact();
 
+        bool isEmpty() { return m_markSets.isEmpty() && m_values.isEmpty(); }
+
         ~MarkStack()
         {
             ASSERT(m_markSets.isEmpty());
@@ -173,6 +184,7 @@ namespace JSC {
         };
 
         void* m_jsArrayVPtr;
+        void* m_jsFunctionVPtr;
         MarkStackArray<MarkSet> m_markSets;
         MarkStackArray<JSCell*> m_values;
         static size_t s_pageSize;
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MegamorphicCache_h
+#define MegamorphicCache_h
+
+#include "Identifier.h"
+#include "JSObject.h"
+#include "Structure.h"
+#include <wtf/RefPtr.h>
+
+namespace JSC {
+
+    // Remembers where own properties live for get_by_id sites whose inline
+    // caches have given up, keyed by (Structure, property name). Entries hold
+    // references so that neither key can be reused while it is cached.
+    class MegamorphicCache : public Noncopyable {
+    public:
+        MegamorphicCache()
+#ifdef ANDROID_INSTRUMENT
+            : m_hits(0)
+            , m_misses(0)
+#endif
+        {
+        }
+
+        bool get(JSCell* base, const Identifier& propertyName, JSValue& result)
+        {
+            Structure* structure = base->structure();
+            CacheEntry& entry = lookup(structure, propertyName.ustring().rep());
+            if (entry.structure != structure || entry.propertyName != propertyName.ustring().rep()) {
+#ifdef ANDROID_INSTRUMENT
+                ++m_misses;
+#endif
+                return false;
+            }
+            ASSERT(base->isObject());
+#ifdef ANDROID_INSTRUMENT
+            ++m_hits;
+#endif
+            result = asObject(base)->getDirectOffset(entry.offset);
+            return true;
+        }
+
+        // Only non-dictionary structures are cached, since a dictionary can
+        // move its properties without changing its Structure.
+        void add(JSCell* base, const Identifier& propertyName, size_t offset)
+        {
+            Structure* structure = base->structure();
+            ASSERT(base->isObject() && !structure->isDictionary());
+            CacheEntry& entry = lookup(structure, propertyName.ustring().rep());
+            entry.structure = structure;
+            entry.propertyName = propertyName.ustring().rep();
+            entry.offset = offset;
+        }
+
+#ifdef ANDROID_INSTRUMENT
+        unsigned hits() const { return m_hits; }
+        unsigned misses() const { return m_misses; }
+
+        // Each get_by_id site that used the cache is bucketed by its hit rate
+        // when its CodeBlock is destroyed, quartiles lowest first.
+        static const size_t siteHitRateBucketCount = 4;
+        struct SiteStatistics {
+            unsigned sites;
+            unsigned sitesByHitRate[siteHitRateBucketCount];
+        };
+
+        static void recordSite(unsigned hits, unsigned misses)
+        {
+            if (!hits && !misses)
+                return;
+            SiteStatistics& statistics = siteStatisticsStorage();
+            ++statistics.sites;
+            size_t bucket = static_cast<size_t>(static_cast<uint64_t>(hits) * siteHitRateBucketCount / (static_cast<uint64_t>(hits) + misses));
+            if (bucket == siteHitRateBucketCount)
+                --bucket;
+            ++statistics.sitesByHitRate[bucket];
+        }
+
+        static const SiteStatistics& siteStatistics() { return siteStatisticsStorage(); }
+#endif
+
+    private:
+        static const size_t cacheSize = 512;
+
+        struct CacheEntry {
+            RefPtr<Structure> structure;
+            RefPtr<UString::Rep> propertyName;
+            size_t offset;
+        };
+
+        CacheEntry& lookup(Structure* structure, UString::Rep* propertyName)
+        {
+            unsigned hash = (reinterpret_cast<uintptr_t>(structure) >> 4) ^ propertyName->existingHash();
+            return m_cache[hash & (cacheSize - 1)];
+        }
+
+#ifdef ANDROID_INSTRUMENT
+        static SiteStatistics& siteStatisticsStorage()
+        {
+            static SiteStatistics statistics;
+            return statistics;
+        }
+#endif
+
+        CacheEntry m_cache[cacheSize];
+#ifdef ANDROID_INSTRUMENT
+        unsigned m_hits;
+        unsigned m_misses;
+#endif
+    };
+
+} // namespace JSC
+
+#endif // MegamorphicCache_h
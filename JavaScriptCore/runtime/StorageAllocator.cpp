@@ -0,0 +1,197 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "StorageAllocator.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace JSC {
+
+// Powers of two and the midpoints between them. Property storage capacities
+// are powers of two, and array vectors grow by half their length.
+const size_t StorageAllocator::s_sizeClasses[sizeClassCount] = {
+    32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024
+};
+
+// Indexed by the size rounded up to sizeClassGranularity.
+const unsigned char StorageAllocator::s_sizeClassIndex[maxSize / sizeClassGranularity + 1] = {
+    0, 0, 0, // 0 - 32
+    1, // 48
+    2, // 64
+    3, 3, // 96
+    4, 4, // 128
+    5, 5, 5, 5, // 192
+    6, 6, 6, 6, // 256
+    7, 7, 7, 7, 7, 7, 7, 7, // 384
+    8, 8, 8, 8, 8, 8, 8, 8, // 512
+    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, // 768
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10 // 1024
+};
+
+StorageAllocator::StorageAllocator()
+    : m_capacity(0)
+    , m_size(0)
+{
+    COMPILE_ASSERT(sizeof(s_sizeClasses) / sizeof(s_sizeClasses[0]) == sizeClassCount, size_class_table_is_complete);
+    COMPILE_ASSERT(!(chunkSize % maxSize), chunk_holds_whole_largest_size_class);
+    for (size_t i = 0; i < sizeClassCount; ++i)
+        m_freeLists[i] = 0;
+}
+
+StorageAllocator::~StorageAllocator()
+{
+    for (size_t i = 0; i < m_chunks.size(); ++i)
+        fastFree(m_chunks[i].base);
+}
+
+bool StorageAllocator::addChunk(size_t sizeClass)
+{
+    char* chunk;
+    if (!tryFastMalloc(chunkSize).getValue(chunk))
+        return false;
+    Chunk newChunk = { chunk, sizeClass };
+    m_chunks.append(newChunk);
+    m_capacity += chunkSize;
+
+    // Thread the chunk onto the free list in address order.
+    size_t storageSize = s_sizeClasses[sizeClass];
+    size_t storageCount = chunkSize / storageSize;
+    FreeStorage* freeList = m_freeLists[sizeClass];
+    for (size_t i = storageCount; i-- > 0; ) {
+        FreeStorage* storage = reinterpret_cast<FreeStorage*>(chunk + i * storageSize);
+        storage->next = freeList;
+        freeList = storage;
+    }
+    m_freeLists[sizeClass] = freeList;
+    return true;
+}
+
+void* StorageAllocator::allocateSlowCase(size_t sizeClass)
+{
+    // Running out of memory crashes, as it does in fastMalloc.
+    if (!addChunk(sizeClass))
+        CRASH();
+    return allocate(s_sizeClasses[sizeClass]);
+}
+
+bool StorageAllocator::chunkBaseLessThan(const Chunk& a, const Chunk& b)
+{
+    return a.base < b.base;
+}
+
+// m_chunks must be sorted by address.
+size_t StorageAllocator::chunkIndexFor(void* p) const
+{
+    size_t low = 0;
+    size_t high = m_chunks.size();
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        if (static_cast<char*>(p) < m_chunks[middle].base)
+            high = middle;
+        else
+            low = middle;
+    }
+    ASSERT(static_cast<char*>(p) >= m_chunks[low].base && static_cast<char*>(p) < m_chunks[low].base + chunkSize);
+    return low;
+}
+
+void StorageAllocator::releaseEmptyChunks()
+{
+    if (m_chunks.isEmpty())
+        return;
+
+    std::sort(m_chunks.begin(), m_chunks.end(), chunkBaseLessThan);
+
+    // A chunk is empty when all of its storage is on the free list of its
+    // size class.
+    Vector<size_t> freeCounts(m_chunks.size());
+    freeCounts.fill(0);
+    for (size_t sizeClass = 0; sizeClass < sizeClassCount; ++sizeClass) {
+        for (FreeStorage* storage = m_freeLists[sizeClass]; storage; storage = storage->next)
+            ++freeCounts[chunkIndexFor(storage)];
+    }
+
+    bool foundEmptyChunk = false;
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        if (freeCounts[i] == chunkSize / s_sizeClasses[m_chunks[i].sizeClass])
+            foundEmptyChunk = true;
+        else
+            freeCounts[i] = 0;
+    }
+    if (!foundEmptyChunk)
+        return;
+
+    for (size_t sizeClass = 0; sizeClass < sizeClassCount; ++sizeClass) {
+        FreeStorage** link = &m_freeLists[sizeClass];
+        while (FreeStorage* storage = *link) {
+            if (freeCounts[chunkIndexFor(storage)])
+                *link = storage->next;
+            else
+                link = &storage->next;
+        }
+    }
+
+    size_t writer = 0;
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        if (freeCounts[i]) {
+            fastFree(m_chunks[i].base);
+            m_capacity -= chunkSize;
+            continue;
+        }
+        m_chunks[writer++] = m_chunks[i];
+    }
+    m_chunks.shrink(writer);
+}
+
+void* StorageAllocator::tryReallocate(void* p, size_t oldSize, size_t newSize)
+{
+    if (oldSize > maxSize && newSize > maxSize) {
+        void* result;
+        if (!tryFastRealloc(p, newSize).getValue(result))
+            return 0;
+        return result;
+    }
+
+    if (oldSize <= maxSize && newSize <= maxSize && sizeClassFor(oldSize) == sizeClassFor(newSize))
+        return p;
+
+    void* result;
+    if (newSize > maxSize) {
+        if (!tryFastMalloc(newSize).getValue(result))
+            return 0;
+    } else {
+        size_t sizeClass = sizeClassFor(newSize);
+        if (!m_freeLists[sizeClass] && !addChunk(sizeClass))
+            return 0;
+        result = allocate(newSize);
+    }
+    memcpy(result, p, std::min(oldSize, newSize));
+    deallocate(p, oldSize);
+    return result;
+}
+
+} // namespace JSC
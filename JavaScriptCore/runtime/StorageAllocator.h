@@ -0,0 +1,123 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef StorageAllocator_h
+#define StorageAllocator_h
+
+#include <wtf/FastMalloc.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    // Size-segregated free lists for the out-of-line storage of heap cells,
+    // such as JSObject property storage and small JSArray vectors. Storage
+    // is carved out of large chunks and handed back with its size, so it
+    // needs no per-allocation header. Larger requests go to fastMalloc.
+    // Like the rest of the heap, this must only be used with the JSLock held.
+    class StorageAllocator : public Noncopyable {
+    public:
+        StorageAllocator();
+        ~StorageAllocator();
+
+        static const size_t maxSize = 1024;
+
+        void* allocate(size_t);
+        void* tryReallocate(void*, size_t oldSize, size_t newSize); // 0 on failure, leaving the old storage intact.
+        void deallocate(void*, size_t);
+
+        // Returns chunks that hold no live storage to the system. Called after
+        // a sweep, when the storage of dead cells has been deallocated.
+        void releaseEmptyChunks();
+
+        size_t capacity() const { return m_capacity; } // Bytes held in chunks.
+        size_t size() const { return m_size; } // Bytes handed out from chunks.
+
+    private:
+        struct FreeStorage {
+            FreeStorage* next;
+        };
+
+        struct Chunk {
+            char* base;
+            size_t sizeClass;
+        };
+
+        static const size_t sizeClassCount = 11;
+        static const size_t sizeClassGranularity = 16;
+        static const size_t chunkSize = 16 * 1024;
+
+        static size_t sizeClassFor(size_t);
+        bool addChunk(size_t sizeClass);
+        void* allocateSlowCase(size_t sizeClass);
+        static bool chunkBaseLessThan(const Chunk&, const Chunk&);
+        size_t chunkIndexFor(void*) const;
+
+        FreeStorage* m_freeLists[sizeClassCount];
+        Vector<Chunk> m_chunks;
+        size_t m_capacity;
+        size_t m_size;
+
+        static const size_t s_sizeClasses[sizeClassCount];
+        static const unsigned char s_sizeClassIndex[maxSize / sizeClassGranularity + 1];
+    };
+
+    inline size_t StorageAllocator::sizeClassFor(size_t size)
+    {
+        ASSERT(size <= maxSize);
+        return s_sizeClassIndex[(size + sizeClassGranularity - 1) / sizeClassGranularity];
+    }
+
+    inline void* StorageAllocator::allocate(size_t size)
+    {
+        if (size > maxSize)
+            return fastMalloc(size);
+
+        size_t sizeClass = sizeClassFor(size);
+        FreeStorage* storage = m_freeLists[sizeClass];
+        if (!storage)
+            return allocateSlowCase(sizeClass);
+        m_freeLists[sizeClass] = storage->next;
+        m_size += s_sizeClasses[sizeClass];
+        return storage;
+    }
+
+    inline void StorageAllocator::deallocate(void* p, size_t size)
+    {
+        if (size > maxSize) {
+            fastFree(p);
+            return;
+        }
+
+        size_t sizeClass = sizeClassFor(size);
+        FreeStorage* storage = static_cast<FreeStorage*>(p);
+        storage->next = m_freeLists[sizeClass];
+        m_freeLists[sizeClass] = storage;
+        m_size -= s_sizeClasses[sizeClass];
+    }
+
+} // namespace JSC
+
+#endif // StorageAllocator_h
@@ -77,7 +77,7 @@ inline MappedType WeakGCMap<KeyType, MappedType>::get(const KeyType& key) const
     MappedType result = m_map.get(key);
     if (result == HashTraits<MappedType>::emptyValue())
         return result;
-    if (!Heap::isCellMarked(result))
+    if (!Heap::isCellLive(result))
         return HashTraits<MappedType>::emptyValue();
     return result;
 }
@@ -88,7 +88,7 @@ MappedType WeakGCMap<KeyType, MappedType>::take(const KeyType& key)
     MappedType result = m_map.take(key);
     if (result == HashTraits<MappedType>::emptyValue())
         return result;
-    if (!Heap::isCellMarked(result))
+    if (!Heap::isCellLive(result))
         return HashTraits<MappedType>::emptyValue();
     return result;
 }
@@ -97,9 +97,10 @@ template<typename KeyType, typename MappedType>
 pair<typename HashMap<KeyType, MappedType>::iterator, bool> WeakGCMap<KeyType, MappedType>::set(const KeyType& key, const MappedType& value)
 {
     Heap::markCell(value); // If value is newly allocated, it's not marked, so mark it now.
+    Heap::writeBarrier(value); // Marking it skips its children, so make the collector visit it again.
     pair<iterator, bool> result = m_map.add(key, value);
     if (!result.second) { // pre-existing entry
-        result.second = !Heap::isCellMarked(result.first->second);
+        result.second = !Heap::isCellLive(result.first->second);
         result.first->second = value;
     }
     return result;
@@ -39,7 +39,7 @@ public:
 
     T* get() const
     {
-        if (!m_ptr || !Heap::isCellMarked(m_ptr))
+        if (!m_ptr || !Heap::isCellLive(m_ptr))
             return 0;
         return m_ptr;
     }
@@ -68,8 +68,12 @@ public:
 private:
     void assign(T* ptr)
     {
-        if (ptr)
+        if (ptr) {
             Heap::markCell(ptr);
+            // Marking a cell outside a collection skips its children, so
+            // make the collector visit it again.
+            Heap::writeBarrier(ptr);
+        }
         m_ptr = ptr;
     }
 
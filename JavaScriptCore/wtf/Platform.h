@@ -806,6 +806,14 @@
 #define ENABLE_SAMPLING_FLAGS 0
 #define ENABLE_OPCODE_SAMPLING 0
 #define ENABLE_CODEBLOCK_SAMPLING 0
+#if !defined(ENABLE_TIERED_COMPILATION)
+#define ENABLE_TIERED_COMPILATION 0
+#endif
+#if ENABLE(TIERED_COMPILATION)
+#define ENABLE_CODEBLOCK_EXECUTION_COUNTERS 1
+#else
+#define ENABLE_CODEBLOCK_EXECUTION_COUNTERS 0
+#endif
 #if ENABLE(CODEBLOCK_SAMPLING) && !ENABLE(OPCODE_SAMPLING)
 #error "CODEBLOCK_SAMPLING requires OPCODE_SAMPLING"
 #endif
@@ -944,6 +952,12 @@ on MinGW. See https://bugs.webkit.org/show_bug.cgi?id=29268 */
     #define WTF_USE_INTERPRETER 1
 #endif
 
+/* Tiered compilation runs cold code in the interpreter and JIT compiles a CodeBlock
+   once its execution counters say it is hot. */
+#if ENABLE(TIERED_COMPILATION) && (!ENABLE(JIT) || !USE(INTERPRETER))
+#error "TIERED_COMPILATION requires both the JIT and the interpreter"
+#endif
+
 /* Yet Another Regex Runtime. */
 #if !defined(ENABLE_YARR_JIT)
 
@@ -1043,4 +1057,26 @@ on MinGW. See https://bugs.webkit.org/show_bug.cgi?id=29268 */
 
 #define ENABLE_JSC_ZOMBIES 0
 
+/* Generational collection in JSC::Heap: collections normally only trace cells
+   allocated since the previous collection, using a block-granular write
+   barrier to find older cells that were stored into. */
+#if !defined(ENABLE_JSC_GENERATIONAL_GC)
+#define ENABLE_JSC_GENERATIONAL_GC 0
+#endif
+
+/* Incremental marking in JSC::Heap: full collections mark in time-bounded
+   slices interleaved with allocation, finishing with a short pause that
+   rescans the roots and the cells the write barrier recorded. */
+#if !defined(ENABLE_JSC_INCREMENTAL_MARKING)
+#define ENABLE_JSC_INCREMENTAL_MARKING 0
+#endif
+
+#if ENABLE(JSC_GENERATIONAL_GC) && ENABLE(JSC_INCREMENTAL_MARKING)
+#error "JSC_GENERATIONAL_GC and JSC_INCREMENTAL_MARKING cannot be enabled together"
+#endif
+
+#if ENABLE(JSC_GENERATIONAL_GC) || ENABLE(JSC_INCREMENTAL_MARKING)
+#define ENABLE_JSC_WRITE_BARRIER 1
+#endif
+
 #endif /* WTF_Platform_h */
@@ -36,6 +36,8 @@ using namespace WTF;
 
 namespace JSC { namespace Yarr {
 
+static const unsigned maximumUnrolledParenthesesCount = 8;
+
 class CharacterClassConstructor {
 public:
     CharacterClassConstructor(bool isCaseInsensitive = false)
@@ -519,6 +521,30 @@ public:
         return termCopy;
     }
 
+    static bool containsCaptures(PatternDisjunction* disjunction)
+    {
+        for (unsigned alt = 0; alt < disjunction->m_alternatives.size(); ++alt) {
+            PatternAlternative* alternative = disjunction->m_alternatives[alt];
+            for (unsigned i = 0; i < alternative->m_terms.size(); ++i) {
+                PatternTerm& term = alternative->m_terms[i];
+                if (term.type == PatternTerm::TypeParenthesesSubpattern && term.capture())
+                    return true;
+                if (((term.type == PatternTerm::TypeParenthesesSubpattern) || (term.type == PatternTerm::TypeParentheticalAssertion))
+                    && containsCaptures(term.parentheses.disjunction))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    // Copies of a group share its capturing subpatterns, so matching one copy can clobber
+    // the captures of another; groups without captures can be copied freely.
+    static bool needsCopySemantics(PatternTerm& term)
+    {
+        ASSERT(term.type == PatternTerm::TypeParenthesesSubpattern);
+        return term.capture() || containsCaptures(term.parentheses.disjunction);
+    }
+
     void quantifyAtom(unsigned min, unsigned max, bool greedy)
     {
         ASSERT(min <= max);
@@ -554,7 +580,24 @@ public:
             // NOTE: this term is interesting from an analysis perspective, in that it can be ignored.....
             m_alternative->lastTerm().quantify((max == UINT_MAX) ? max : max - min, greedy ? QuantifierGreedy : QuantifierNonGreedy);
             if (m_alternative->lastTerm().type == PatternTerm::TypeParenthesesSubpattern)
-                m_alternative->lastTerm().parentheses.isCopy = true;
+                m_alternative->lastTerm().parentheses.isCopy = needsCopySemantics(m_alternative->lastTerm());
+        }
+
+        // Spell out short fixed repeats of groups without captures, e.g. (?:\d+\.){3}, as
+        // consecutive groups matched once each, which the JIT can generate inline.
+        if (!min)
+            return;
+        unsigned fixedTermIndex = m_alternative->m_terms.size() - ((min == max) ? 1 : 2);
+        PatternTerm& fixedTerm = m_alternative->m_terms[fixedTermIndex];
+        if ((fixedTerm.type == PatternTerm::TypeParenthesesSubpattern) && (fixedTerm.quantityCount > 1)
+            && (fixedTerm.quantityCount <= maximumUnrolledParenthesesCount) && !needsCopySemantics(fixedTerm)) {
+            unsigned count = fixedTerm.quantityCount;
+            fixedTerm.quantify(1, QuantifierFixedCount);
+            PatternTerm original = fixedTerm;
+            Vector<PatternTerm> copies;
+            for (unsigned i = 1; i < count; ++i)
+                copies.append(copyTerm(original));
+            m_alternative->m_terms.insert(fixedTermIndex + 1, copies.data(), copies.size());
         }
     }
 
@@ -36,6 +36,13 @@
 
 #if ENABLE(YARR_JIT)
 
+// Set to 1 to print every pattern that falls back to pcre, and why.
+#define DUMP_REGEX_JIT_FALLBACKS 0
+
+#if DUMP_REGEX_JIT_FALLBACKS
+#include <stdio.h>
+#endif
+
 using namespace WTF;
 
 namespace JSC { namespace Yarr {
@@ -556,6 +563,53 @@ class RegexGenerator : private MacroAssembler {
             state.jumpToBacktrack(branch32WithUnalignedHalfWords(NotEqual, BaseIndex(input, index, TimesTwo, state.inputOffset() * sizeof(UChar)), Imm32(chPair)), this);
     }
 
+    // Matches the text last captured by a group, which is known to precede this term. The
+    // capture is consumed in one go, so the only way to backtrack is out of this term.
+    void generateBackReference(TermGenerationState& state)
+    {
+        const RegisterID character = regT0;
+        const RegisterID matchIndex = regT1;
+        PatternTerm& term = state.term();
+        ASSERT((term.quantityType == QuantifierFixedCount) && (term.quantityCount == 1));
+        ASSERT(!m_pattern.m_ignoreCase);
+
+        unsigned indexFrameLocation = term.frameLocation;
+        unsigned matchEndFrameLocation = term.frameLocation + 1;
+
+        storeToFrame(index, indexFrameLocation);
+
+        // A group that has not participated in the match, or matched the empty string, matches the empty string.
+        JumpList matchesEmpty;
+        load32(Address(output, (term.subpatternId << 1) * sizeof(int)), matchIndex);
+        load32(Address(output, ((term.subpatternId << 1) + 1) * sizeof(int)), character);
+        matchesEmpty.append(branch32(Equal, matchIndex, Imm32(-1)));
+        matchesEmpty.append(branch32(GreaterThanOrEqual, matchIndex, character));
+        storeToFrame(character, matchEndFrameLocation);
+
+        // As for greedy terms, index never passes the end of the input.
+        JumpList failures;
+        sub32(matchIndex, character);
+        add32(index, character);
+        failures.append(branch32(Above, character, length));
+
+        Label loop(this);
+        load16(BaseIndex(input, matchIndex, TimesTwo, 0), character);
+        failures.append(branch16(NotEqual, BaseIndex(input, index, TimesTwo, state.inputOffset() * sizeof(UChar)), character));
+        add32(Imm32(1), matchIndex);
+        add32(Imm32(1), index);
+        branch32(NotEqual, matchIndex, Address(stackPointerRegister, matchEndFrameLocation * sizeof(void*))).linkTo(loop, this);
+        Jump success = jump();
+
+        Label backtrackBegin(this);
+        failures.link(this);
+        loadFromFrame(indexFrameLocation, index);
+        state.jumpToBacktrack(jump(), this);
+
+        matchesEmpty.link(this);
+        success.link(this);
+        state.setBacktrackGenerated(backtrackBegin);
+    }
+
     void generatePatternCharacterFixed(TermGenerationState& state)
     {
         const RegisterID character = regT0;
@@ -1078,7 +1132,12 @@ class RegexGenerator : private MacroAssembler {
             break;
 
         case PatternTerm::TypeBackReference:
-            m_generationFailed = true;
+            if ((term.quantityType != QuantifierFixedCount) || (term.quantityCount != 1))
+                fallBack(RegexJITFallbackQuantifiedBackReference);
+            else if (m_pattern.m_ignoreCase)
+                fallBack(RegexJITFallbackIgnoreCaseBackReference);
+            else
+                generateBackReference(state);
             break;
 
         case PatternTerm::TypeForwardReference:
@@ -1087,8 +1146,10 @@ class RegexGenerator : private MacroAssembler {
         case PatternTerm::TypeParenthesesSubpattern:
             if ((term.quantityCount == 1) && !term.parentheses.isCopy)
                 generateParenthesesSingle(state);
+            else if (term.quantityCount == 1)
+                fallBack(RegexJITFallbackCopiedCapturingParentheses);
             else
-                m_generationFailed = true;
+                fallBack(RegexJITFallbackQuantifiedParentheses);
             break;
 
         case PatternTerm::TypeParentheticalAssertion:
@@ -1316,6 +1377,13 @@ class RegexGenerator : private MacroAssembler {
 #endif
     }
 
+    void fallBack(RegexJITFallbackReason reason)
+    {
+        // Report the first construct that could not be generated.
+        if (m_fallbackReason == RegexJITFallbackNone)
+            m_fallbackReason = reason;
+    }
+
     void generateReturn()
     {
 #if CPU(X86_64)
@@ -1337,7 +1405,7 @@ class RegexGenerator : private MacroAssembler {
 public:
     RegexGenerator(RegexPattern& pattern)
         : m_pattern(pattern)
-        , m_generationFailed(false)
+        , m_fallbackReason(RegexJITFallbackNone)
     {
     }
 
@@ -1369,15 +1437,47 @@ public:
 
     bool generationFailed()
     {
-        return m_generationFailed;
+        return m_fallbackReason != RegexJITFallbackNone;
+    }
+
+    RegexJITFallbackReason fallbackReason()
+    {
+        return m_fallbackReason;
     }
 
 private:
     RegexPattern& m_pattern;
     Vector<AlternativeBacktrackRecord> m_backtrackRecords;
-    bool m_generationFailed;
+    RegexJITFallbackReason m_fallbackReason;
 };
 
+static RegexJITStatistics statistics;
+
+const RegexJITStatistics& regexJITStatistics()
+{
+    return statistics;
+}
+
+const char* regexJITFallbackReasonName(RegexJITFallbackReason reason)
+{
+    switch (reason) {
+    case RegexJITFallbackNone:
+        return "none";
+    case RegexJITFallbackQuantifiedBackReference:
+        return "quantified back-reference";
+    case RegexJITFallbackIgnoreCaseBackReference:
+        return "case-insensitive back-reference";
+    case RegexJITFallbackQuantifiedParentheses:
+        return "quantified parentheses";
+    case RegexJITFallbackCopiedCapturingParentheses:
+        return "repeated parentheses containing captures";
+    case NumberOfRegexJITFallbackReasons:
+        break;
+    }
+    ASSERT_NOT_REACHED();
+    return 0;
+}
+
 void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const UString& patternString, unsigned& numSubpatterns, const char*& error, bool ignoreCase, bool multiline)
 {
     RegexPattern pattern(ignoreCase, multiline);
@@ -1390,7 +1490,13 @@ void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const
     RegexGenerator generator(pattern);
     generator.compile(globalData, jitObject);
 
+    ++statistics.compiledPatterns;
+    ++statistics.fallbacks[generator.fallbackReason()];
+
     if (generator.generationFailed()) {
+#if DUMP_REGEX_JIT_FALLBACKS
+        fprintf(stderr, "RegexJIT: /%s/ runs on pcre: %s\n", patternString.UTF8String().c_str(), regexJITFallbackReasonName(generator.fallbackReason()));
+#endif
         JSRegExpIgnoreCaseOption ignoreCaseOption = ignoreCase ? JSRegExpIgnoreCase : JSRegExpDoNotIgnoreCase;
         JSRegExpMultilineOption multilineOption = multiline ? JSRegExpMultiline : JSRegExpSingleLine;
         jitObject.setFallback(jsRegExpCompile(reinterpret_cast<const UChar*>(patternString.data()), patternString.size(), ignoreCaseOption, multilineOption, &numSubpatterns, &error));
@@ -83,6 +83,24 @@ private:
 
 void jitCompileRegex(JSGlobalData* globalData, RegexCodeBlock& jitObject, const UString& pattern, unsigned& numSubpatterns, const char*& error, bool ignoreCase = false, bool multiline = false);
 
+// Why a pattern could not be compiled to native code and runs on pcre instead.
+enum RegexJITFallbackReason {
+    RegexJITFallbackNone,
+    RegexJITFallbackQuantifiedBackReference,
+    RegexJITFallbackIgnoreCaseBackReference,
+    RegexJITFallbackQuantifiedParentheses,
+    RegexJITFallbackCopiedCapturingParentheses,
+    NumberOfRegexJITFallbackReasons
+};
+
+struct RegexJITStatistics {
+    unsigned compiledPatterns;
+    unsigned fallbacks[NumberOfRegexJITFallbackReasons];
+};
+
+const RegexJITStatistics& regexJITStatistics();
+const char* regexJITFallbackReasonName(RegexJITFallbackReason);
+
 inline int executeRegex(RegexCodeBlock& jitObject, const UChar* input, unsigned start, unsigned length, int* output, int outputArraySize)
 {
     if (JSRegExp* fallback = jitObject.getFallback())
@@ -198,10 +198,10 @@ void JSValueWrapper::JSObjectMark(void *data)
     if (ptr)
     {
         // This results in recursive marking but will be otherwise safe and correct.
-        // We claim the array vptr is 0 because we don't have access to it here, and
-        // claiming 0 is functionally harmless -- it merely means that we can't
-        // devirtualise marking of arrays when recursing from this point.
-        MarkStack markStack(0);
+        // We claim the array and function vptrs are 0 because we don't have access
+        // to them here, and claiming 0 is functionally harmless -- it merely means
+        // that we can't devirtualise marking of arrays when recursing from this point.
+        MarkStack markStack(0, 0);
         markStack.append(ptr->fValue.get());
         markStack.drain();
     }
@@ -0,0 +1,52 @@
+description("Tests back-references, including references to groups that did not participate in the match and backtracking across a back-reference.");
+
+debug("Simple back-references");
+shouldBe("/(['\"]).*?\\1/.exec(\"say 'hi' now\")", "[\"'hi'\", \"'\"]");
+shouldBe("/(['\"]).*?\\1/.exec('a \"b\\'c\" d')", "['\"b\\'c\"', '\"']");
+shouldBe("/(a+)b\\1/.exec('aaabaa')", "['aabaa', 'aa']");
+shouldBe("/(\\w+) \\1/.exec('the the cat')", "['the the', 'the']");
+shouldBeNull("/(\\w+) \\1$/.exec('the thee')");
+shouldBe("/<(\\w+)>.*<\\/\\1>/.exec('<b><i>x</i></b>')", "['<b><i>x</i></b>', 'b']");
+shouldBe("/(x)(y)\\2\\1/.exec('xyyx')", "['xyyx', 'x', 'y']");
+shouldBe("/()\\1/.exec('abc')", "['', '']");
+shouldBe("'aa bb cd ee'.replace(/(\\w)\\1/g, '<$1>')", "'<a> <b> cd <e>'");
+
+debug("");
+debug("Back-references to groups that did not participate");
+shouldBe("/(a)|b\\1/.exec('b')", "['b', undefined]");
+shouldBe("/(?:(a)|b)\\1c/.exec('bc')", "['bc', undefined]");
+shouldBe("/(?:(a)|(b))\\1\\2/.exec('bb')", "['bb', undefined, 'b']");
+shouldBe("/(a)?b\\1/.exec('b')", "['b', undefined]");
+shouldBe("/\\1(a)/.exec('aa')", "['a', 'a']");
+shouldBe("/(a\\1)/.exec('aa')", "['a', 'a']");
+
+debug("");
+debug("Back-references after a group was reset by backtracking");
+shouldBe("/(?:(a)b|ac)\\1/.exec('ac')", "['ac', undefined]");
+shouldBe("/(?:(a)x|a)y\\1/.exec('ay')", "['ay', undefined]");
+shouldBe("/(a*)b?\\1c/.exec('aac')", "['aac', 'a']");
+shouldBe("/(a|ab)\\1c/.exec('ababc')", "['ababc', 'ab']");
+
+debug("");
+debug("Backtracking across a back-reference");
+shouldBe("/(a+)\\1b/.exec('aaaab')", "['aaaab', 'aa']");
+shouldBe("/(a+)\\1b/.exec('aaaaab')", "['aaaab', 'aa']");
+shouldBe("/(a+?)\\1+b/.exec('aaaab')", "['aaaab', 'a']");
+shouldBe("/(\\d+)-\\1x|(\\d+)y/.exec('12-12y')", "['12y', undefined, '12']");
+shouldBe("/(.*)\\1$/.exec('abcabc')", "['abcabc', 'abc']");
+shouldBe("/^(.+)\\1+$/.exec('xyxyxy')", "['xyxyxy', 'xy']");
+shouldBeNull("/^(ab)\\1c/.exec('ababab')");
+shouldBe("/(.)\\1(?!\\1)/.exec('aaab')", "['aa', 'a']");
+
+debug("");
+debug("Case-insensitive back-references");
+shouldBe("/(a)\\1/i.exec('aA')", "['aA', 'a']");
+shouldBe("/(ab)\\1/i.exec('xAbaBx')", "['AbaB', 'Ab']");
+shouldBe("/(\\w+) \\1/i.exec('The the')", "['The the', 'The']");
+shouldBeNull("/(\\w+) \\1/.exec('The the')");
+shouldBe("/<(\\w+)>.*<\\/\\1>/i.exec('<B>x</b>')", "['<B>x</b>', 'B']");
+shouldBe("/(a+)\\1b/i.exec('aAAAb')", "['aAAAb', 'aA']");
+shouldBe("/(\\u00e9)\\1/i.exec('\\u00e9\\u00c9')", "['\\u00e9\\u00c9', '\\u00e9']");
+shouldBe("/(a)|b\\1/i.exec('B')", "['B', undefined]");
+
+var successfullyParsed = true;
@@ -0,0 +1,23 @@
+description("Tests groups repeated a fixed number of times, with and without captures.");
+
+debug("Groups without captures");
+shouldBe("/(?:\\d+\\.){3}\\d+/.exec('ip 192.168.0.1 up')", "['192.168.0.1']");
+shouldBeNull("/^(?:\\d+\\.){3}\\d+$/.exec('1.2.3')");
+shouldBe("/(?:ab){2}/.exec('abababx')", "['abab']");
+shouldBe("/(?:a|bc){3}d/.exec('abcbcad')", "['bcbcad']");
+shouldBe("/(?:a+){2}b/.exec('aaab')", "['aaab']");
+shouldBe("/(?:ab){1,2}c/.exec('ababc')", "['ababc']");
+shouldBe("/(?:ab){0,1}c/.exec('xc')", "['c']");
+
+debug("");
+debug("Groups with captures");
+shouldBe("/(\\d+\\.){3}(\\d+)/.exec('10.0.0.254')", "['10.0.0.254', '0.', '254']");
+shouldBe("/(a|b){3}/.exec('abb')", "['abb', 'b']");
+shouldBe("/(?:(a)|b){2}/.exec('ba')", "['ba', 'a']");
+shouldBe("/(?:x(\\d)){3}/.exec('x1x2x3')", "['x1x2x3', '3']");
+shouldBe("/(?:(\\w)(\\d)){2}-\\1\\2/.exec('a1b2-b2')", "['a1b2-b2', 'b', '2']");
+shouldBe("/((a+)b){2}/.exec('aabab')", "['aabab', 'ab', 'a']");
+shouldBe("/((a+)b){2}c/.exec('abaabc')", "['abaabc', 'aab', 'aa']");
+shouldBe("/(ab){1,2}c/.exec('ababc')", "['ababc', 'ab']");
+
+var successfullyParsed = true;
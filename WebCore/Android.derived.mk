@@ -89,6 +89,7 @@ $(GEN): $(LOCAL_PATH)/css/tokenizer.flex $(LOCAL_PATH)/css/maketokenizer
 	$(transform-generated-source)
 # we have to do this dep by hand:
 $(intermediates)/css/CSSParser.o : $(GEN)
+$(intermediates)/css/BackgroundCSSTokenizer.o : $(GEN)
 
 # CSS grammar
 
@@ -26,6 +26,7 @@
 LOCAL_SRC_FILES := \
 	bindings/generic/BindingSecurityBase.cpp \
 	\
+	css/BackgroundCSSTokenizer.cpp \
 	css/CSSBorderImageValue.cpp \
 	css/CSSCanvasValue.cpp \
 	css/CSSCharsetRule.cpp \
@@ -163,9 +164,11 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	dom/ScriptExecutionContext.cpp \
 	dom/SelectElement.cpp \
 	dom/SelectorNodeList.cpp \
+	dom/SelectorQueryCache.cpp \
 	dom/SpaceSplitString.cpp \
 	dom/StaticNodeList.cpp \
 	dom/StyleElement.cpp \
+	dom/StyleRecalcStatistics.cpp \
 	dom/StyledElement.cpp \
 	dom/TagNodeList.cpp \
 	dom/Text.cpp \
@@ -241,6 +244,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	\
 	history/android/HistoryItemAndroid.cpp \
 	\
+	html/BackgroundPreloadScanner.cpp \
 	html/Blob.cpp \
 	html/CollectionCache.cpp \
 	html/DateComponents.cpp \
@@ -368,6 +368,7 @@ SOURCES += \
     bridge/c/c_runtime.cpp \
     bridge/c/c_utility.cpp \
     bridge/jsc/BridgeJSC.cpp \
+    css/BackgroundCSSTokenizer.cpp \
     css/CSSBorderImageValue.cpp \
     css/CSSCanvasValue.cpp \
     css/CSSCharsetRule.cpp \
@@ -495,6 +496,7 @@ SOURCES += \
     dom/ScriptExecutionContext.cpp \
     dom/SelectElement.cpp \
     dom/SelectorNodeList.cpp \
+    dom/SelectorQueryCache.cpp \
     dom/SpaceSplitString.cpp \
     dom/StaticNodeList.cpp \
     dom/StyledElement.cpp \
@@ -568,6 +570,7 @@ SOURCES += \
     history/HistoryItem.cpp \
     history/qt/HistoryItemQt.cpp \
     history/PageCache.cpp \
+    html/BackgroundPreloadScanner.cpp \
     html/Blob.cpp \
     html/canvas/CanvasGradient.cpp \
     html/canvas/CanvasPattern.cpp \
@@ -1062,11 +1065,13 @@ HEADERS += \
     bridge/runtime_method.h \
     bridge/runtime_object.h \
     bridge/runtime_root.h \
+    css/BackgroundCSSTokenizer.h \
     css/CSSBorderImageValue.h \
     css/CSSCanvasValue.h \
     css/CSSCharsetRule.h \
     css/CSSComputedStyleDeclaration.h \
     css/CSSCursorImageValue.h \
+    css/CSSFlexScanner.h \
     css/CSSFontFace.h \
     css/CSSFontFaceRule.h \
     css/CSSFontFaceSource.h \
@@ -1187,6 +1192,7 @@ HEADERS += \
     dom/ScriptExecutionContext.h \
     dom/SelectElement.h \
     dom/SelectorNodeList.h \
+    dom/SelectorQueryCache.h \
     dom/SpaceSplitString.h \
     dom/StaticNodeList.h \
     dom/StyledElement.h \
@@ -1256,6 +1262,7 @@ HEADERS += \
     history/CachedPage.h \
     history/HistoryItem.h \
     history/PageCache.h \
+    html/BackgroundPreloadScanner.h \
     html/Blob.h \
     html/canvas/CanvasGradient.h \
     html/canvas/CanvasPattern.h \
@@ -1559,6 +1566,7 @@ HEADERS += \
     platform/sql/SQLiteStatement.h \
     platform/sql/SQLiteTransaction.h \
     platform/sql/SQLValue.h \
+    platform/text/ASCIIFastPath.h \
     platform/text/AtomicString.h \
     platform/text/Base64.h \
     platform/text/BidiContext.h \
@@ -130,6 +130,23 @@
 
 #define ENABLE_COLOR_INVERSION 1
 
+// Scans incoming network data for subresources on a background thread.
+// Off until PreloadScanner stops creating Strings: their refcounts are not
+// atomic, and the shared empty string is touched from both threads.
+#define ENABLE_BACKGROUND_PRELOAD_SCANNER 0
+
+// Scans large downloaded style sheets on a background thread before parsing
+#define ENABLE_BACKGROUND_CSS_TOKENIZER 1
+
+// Keeps the page content rasterized in tiles between UI thread draws
+#define ENABLE_PICTURE_SET_TILE_CACHE 1
+
+// Records changed page content in grid cells instead of one picture
+#define ENABLE_PICTURE_SET_GRID 1
+
+// Records overdrawn page content again as one picture when idle
+#define ENABLE_PICTURE_SET_COMPACTION 1
+
 #define FLATTEN_FRAMESET
 #define FLATTEN_IFRAME
 
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "BackgroundCSSTokenizer.h"
+
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+
+#include "CSSParser.h"
+#include "CSSSelector.h"
+#include "CachedCSSStyleSheet.h"
+#include "MediaQuery.h"
+#include "PlatformString.h"
+#include <wtf/HashMap.h>
+#include <wtf/MainThread.h>
+#include <wtf/MessageQueue.h>
+#include <wtf/OwnPtr.h>
+#include <wtf/StdLibExtras.h>
+
+namespace WebCore {
+
+static const unsigned minimumSheetLength = 16 * 1024;
+
+// The state the flex scanner works on, without the rest of CSSParser. Used on
+// the background thread only.
+class CSSTokenScanner : public Noncopyable {
+public:
+    CSSTokenScanner(UChar* characters)
+        : yytext(characters)
+        , yy_c_buf_p(characters)
+        , yy_hold_char(*characters)
+        , yy_last_accepting_state(0)
+        , yy_last_accepting_cpos(0)
+        , yyleng(0)
+        , yyTok(0)
+        , yy_start(1)
+    {
+    }
+
+    int lex();
+    const UChar* text() const { return yytext; }
+    int length() const { return yyleng; }
+
+private:
+    UChar* yytext;
+    UChar* yy_c_buf_p;
+    UChar yy_hold_char;
+    int yy_last_accepting_state;
+    UChar* yy_last_accepting_cpos;
+    int yyleng;
+    int yyTok;
+    int yy_start;
+};
+
+// A single thread shared by all style sheets, created on first use and kept
+// for the lifetime of the process.
+class CSSTokenizerThread : public Noncopyable {
+public:
+    static CSSTokenizerThread& shared();
+
+    void append(PassRefPtr<BackgroundCSSTokenizer> tokenizer) { m_queue.append(new Task(tokenizer)); }
+
+private:
+    CSSTokenizerThread();
+
+    struct Task {
+        Task(PassRefPtr<BackgroundCSSTokenizer> tokenizer) : tokenizer(tokenizer) { }
+        RefPtr<BackgroundCSSTokenizer> tokenizer;
+    };
+
+    static void* threadEntryPointCallback(void*);
+    void* threadEntryPoint();
+
+    MessageQueue<Task> m_queue;
+    ThreadIdentifier m_threadID;
+};
+
+CSSTokenizerThread& CSSTokenizerThread::shared()
+{
+    ASSERT(isMainThread());
+    DEFINE_STATIC_LOCAL(CSSTokenizerThread, thread, ());
+    return thread;
+}
+
+CSSTokenizerThread::CSSTokenizerThread()
+{
+    m_threadID = createThread(CSSTokenizerThread::threadEntryPointCallback, this, "WebCore: CSSTokenizer");
+}
+
+void* CSSTokenizerThread::threadEntryPointCallback(void* thread)
+{
+    return static_cast<CSSTokenizerThread*>(thread)->threadEntryPoint();
+}
+
+void* CSSTokenizerThread::threadEntryPoint()
+{
+    ASSERT(!isMainThread());
+    while (OwnPtr<Task> task = m_queue.waitForMessage())
+        task->tokenizer->tokenize();
+    return 0;
+}
+
+typedef HashMap<StringImpl*, BackgroundCSSTokenizer*> SheetTextMap;
+
+static SheetTextMap& tokenizersBySheetText()
+{
+    DEFINE_STATIC_LOCAL(SheetTextMap, map, ());
+    return map;
+}
+
+bool BackgroundCSSTokenizer::shouldTokenize(const String& sheetText)
+{
+    return sheetText.length() >= minimumSheetLength;
+}
+
+PassRefPtr<BackgroundCSSTokenizer> BackgroundCSSTokenizer::create(CachedCSSStyleSheet* sheet, const String& sheetText)
+{
+    RefPtr<BackgroundCSSTokenizer> tokenizer = adoptRef(new BackgroundCSSTokenizer(sheet, sheetText));
+    CSSTokenizerThread::shared().append(tokenizer);
+    return tokenizer.release();
+}
+
+BackgroundCSSTokenizer::BackgroundCSSTokenizer(CachedCSSStyleSheet* sheet, const String& sheetText)
+    : m_sheet(sheet)
+    , m_sheetText(0)
+{
+    ASSERT(isMainThread());
+    unsigned length = sheetText.length();
+    m_characters.reserveInitialCapacity(length + 2);
+    m_characters.append(sheetText.characters(), length);
+    m_characters.append(0);
+    m_characters.append(0);
+}
+
+BackgroundCSSTokenizer::~BackgroundCSSTokenizer()
+{
+    ASSERT(!m_sheetText);
+}
+
+void BackgroundCSSTokenizer::tokenize()
+{
+    ASSERT(!isMainThread());
+    UChar* characters = m_characters.data();
+    CSSTokenScanner scanner(characters);
+    while (int token = scanner.lex())
+        m_tokens.append(CSSToken(token, scanner.text() - characters, scanner.length()));
+    m_tokens.shrinkToFit();
+    m_characters.clear();
+
+    // Balanced in didFinishTokenizingCallback().
+    ref();
+    callOnMainThread(BackgroundCSSTokenizer::didFinishTokenizingCallback, this);
+}
+
+void BackgroundCSSTokenizer::didFinishTokenizingCallback(void* context)
+{
+    BackgroundCSSTokenizer* tokenizer = static_cast<BackgroundCSSTokenizer*>(context);
+    if (tokenizer->m_sheet)
+        tokenizer->m_sheet->tokenizationFinished();
+    tokenizer->deref();
+}
+
+void BackgroundCSSTokenizer::setSheetText(const String& sheetText)
+{
+    ASSERT(isMainThread());
+    ASSERT(!m_sheetText);
+    if (sheetText.isNull())
+        return;
+    m_sheetText = sheetText.impl();
+    tokenizersBySheetText().set(m_sheetText, this);
+}
+
+void BackgroundCSSTokenizer::clearSheetText()
+{
+    ASSERT(isMainThread());
+    if (!m_sheetText)
+        return;
+    tokenizersBySheetText().remove(m_sheetText);
+    m_sheetText = 0;
+}
+
+BackgroundCSSTokenizer* BackgroundCSSTokenizer::tokensForSheetText(const String& sheetText)
+{
+    ASSERT(isMainThread());
+    SheetTextMap& map = tokenizersBySheetText();
+    if (map.isEmpty() || sheetText.isNull())
+        return 0;
+    return map.get(sheetText.impl());
+}
+
+#define END_TOKEN 0
+
+#include "CSSGrammar.h"
+
+#define YY_DECL int CSSTokenScanner::lex()
+#include "CSSFlexScanner.h"
+
+} // namespace WebCore
+
+#endif // ENABLE(BACKGROUND_CSS_TOKENIZER)
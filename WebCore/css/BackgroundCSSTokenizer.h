@@ -0,0 +1,107 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BackgroundCSSTokenizer_h
+#define BackgroundCSSTokenizer_h
+
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+
+#include <wtf/PassRefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/unicode/Unicode.h>
+
+namespace WebCore {
+
+class CachedCSSStyleSheet;
+class String;
+class StringImpl;
+
+struct CSSToken {
+    CSSToken(int type, unsigned offset, unsigned length)
+        : type(type)
+        , offset(offset)
+        , length(length)
+    {
+    }
+
+    int type;
+    // Position of the token in the text handed to CSSParser::parseSheet().
+    unsigned offset;
+    unsigned length;
+};
+
+// Runs the flex scanner over the text of a downloaded style sheet on a
+// background thread. CSSParser::parseSheet() then replays the tokens instead
+// of scanning the text itself. Building the rule tree has to stay on the main
+// thread: it creates AtomicStrings and shares values between sheets, neither
+// of which is thread safe. The scanner only ever sees a private copy of the
+// characters, so nothing but this object is shared with the main thread.
+class BackgroundCSSTokenizer : public ThreadSafeShared<BackgroundCSSTokenizer> {
+public:
+    // Sheets smaller than this parse quickly enough that waiting for the
+    // background thread would only delay them.
+    static bool shouldTokenize(const String& sheetText);
+
+    // Starts tokenizing sheetText. The sheet's tokenizationFinished() is called
+    // on the main thread once the tokens are ready.
+    static PassRefPtr<BackgroundCSSTokenizer> create(CachedCSSStyleSheet*, const String& sheetText);
+    ~BackgroundCSSTokenizer();
+
+    // The sheet no longer wants to hear about the tokens.
+    void detach() { m_sheet = 0; }
+
+    // Makes the tokens available to CSSParser::parseSheet() calls made for
+    // sheetText until clearSheetText(). Main thread only.
+    void setSheetText(const String& sheetText);
+    void clearSheetText();
+    static BackgroundCSSTokenizer* tokensForSheetText(const String&);
+
+    // Only valid once tokenizationFinished() has been called.
+    size_t size() const { return m_tokens.size(); }
+    const CSSToken& at(size_t i) const { return m_tokens[i]; }
+
+private:
+    BackgroundCSSTokenizer(CachedCSSStyleSheet*, const String& sheetText);
+
+    // Called on the background thread.
+    void tokenize();
+    friend class CSSTokenizerThread;
+
+    static void didFinishTokenizingCallback(void*);
+
+    CachedCSSStyleSheet* m_sheet;
+    StringImpl* m_sheetText;
+    // The sheet text followed by the two NULs the scanner expects at the end
+    // of its buffer. Dropped once it has been scanned.
+    Vector<UChar> m_characters;
+    Vector<CSSToken> m_tokens;
+};
+
+} // namespace WebCore
+
+#endif // ENABLE(BACKGROUND_CSS_TOKENIZER)
+
+#endif // BackgroundCSSTokenizer_h
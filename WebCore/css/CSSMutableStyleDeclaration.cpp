@@ -484,7 +484,7 @@ void CSSMutableStyleDeclaration::setNeedsStyleRecalc()
     while (StyleBase* parent = root->parent())
         root = parent;
     if (root->isCSSStyleSheet())
-        static_cast<CSSStyleSheet*>(root)->doc()->updateStyleSelector();
+        static_cast<CSSStyleSheet*>(root)->styleSheetChanged();
 }
 
 bool CSSMutableStyleDeclaration::getPropertyPriority(int propertyID) const
@@ -594,6 +594,7 @@ void CSSMutableStyleDeclaration::addParsedProperties(const CSSProperty* const* p
 {
     ASSERT(!m_iteratorCount);
     
+    bool wasEmpty = m_properties.isEmpty();
     m_properties.reserveCapacity(numProperties);
     
     for (int i = 0; i < numProperties; ++i) {
@@ -606,6 +607,9 @@ void CSSMutableStyleDeclaration::addParsedProperties(const CSSProperty* const* p
                 m_variableDependentValueCount++;
         }
     }
+    // Overridden duplicates leave unused capacity behind in a freshly parsed declaration.
+    if (wasEmpty && m_properties.capacity() > m_properties.size())
+        m_properties.shrinkToFit();
     // FIXME: This probably should have a call to setNeedsStyleRecalc() if something changed. We may also wish to add
     // a notifyChanged argument to this function to follow the model of other functions in this class.
 }
@@ -786,7 +790,7 @@ void CSSMutableStyleDeclaration::removePropertiesInSet(const int* set, unsigned
     for (unsigned i = 0; i < length; ++i)
         toRemove.add(set[i]);
     
-    Vector<CSSProperty, 4> newProperties;
+    Vector<CSSProperty> newProperties;
     newProperties.reserveInitialCapacity(m_properties.size());
     
     unsigned size = m_properties.size();
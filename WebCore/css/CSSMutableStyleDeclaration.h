@@ -157,7 +157,9 @@ private:
     Vector<CSSProperty>::const_iterator findPropertyWithId(int propertyId) const;
     Vector<CSSProperty>::iterator findPropertyWithId(int propertyId);
 
-    Vector<CSSProperty, 4> m_properties;
+    // No inline capacity: most declarations hold one or two properties, and parsed ones
+    // get exactly the capacity they need.
+    Vector<CSSProperty> m_properties;
 
     Node* m_node;
     unsigned m_variableDependentValueCount : 24;
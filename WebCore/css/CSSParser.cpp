@@ -25,6 +25,7 @@
 #include "config.h"
 #include "CSSParser.h"
 
+#include "BackgroundCSSTokenizer.h"
 #include "CString.h"
 #include "CSSTimingFunctionValue.h"
 #include "CSSBorderImageValue.h"
@@ -147,6 +148,9 @@ CSSParser::CSSParser(bool strictParsing)
     , m_defaultNamespace(starAtom)
     , m_data(0)
     , yy_start(1)
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+    , m_nextBackgroundToken(0)
+#endif
     , m_allowImportRules(true)
     , m_allowVariablesRules(true)
     , m_allowNamespaceDeclarations(true)
@@ -224,18 +228,46 @@ void CSSParser::setupParser(const char* prefix, const String& string, const char
     yy_hold_char = *yy_c_buf_p;
 }
 
+#ifdef ANDROID_INSTRUMENT
+static unsigned styleSheetCount = 0;
+static size_t styleSheetSharedValueSavings = 0;
+
+unsigned CSSParser::parsedStyleSheetCount()
+{
+    return styleSheetCount;
+}
+
+size_t CSSParser::sharedValueSavings()
+{
+    return styleSheetSharedValueSavings;
+}
+#endif
+
 void CSSParser::parseSheet(CSSStyleSheet* sheet, const String& string)
 {
 #ifdef ANDROID_INSTRUMENT
     android::TimeCounter::start(android::TimeCounter::CSSParseTimeCounter);
+    unsigned cacheHits = CSSPrimitiveValue::numberAndStringCacheHits();
 #endif
     m_styleSheet = sheet;
     m_defaultNamespace = starAtom; // Reset the default namespace.
     
     setupParser("", string, "");
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+    m_backgroundTokens = BackgroundCSSTokenizer::tokensForSheetText(string);
+    m_nextBackgroundToken = 0;
+#endif
     cssyyparse(this);
     m_rule = 0;
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+    m_backgroundTokens = 0;
+#endif
 #ifdef ANDROID_INSTRUMENT
+    // Everything this sheet got from the number and string value caches would
+    // have been a new value otherwise.
+    size_t savings = (CSSPrimitiveValue::numberAndStringCacheHits() - cacheHits) * sizeof(CSSPrimitiveValue);
+    ++styleSheetCount;
+    styleSheetSharedValueSavings += savings;
     android::TimeCounter::record(android::TimeCounter::CSSParseTimeCounter, __FUNCTION__);
 #endif
 }
@@ -4689,7 +4721,12 @@ int CSSParser::lex(void* yylvalWithoutType)
     YYSTYPE* yylval = static_cast<YYSTYPE*>(yylvalWithoutType);
     int length;
     
-    lex();
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+    if (m_backgroundTokens)
+        replayBackgroundToken();
+    else
+#endif
+        lex();
 
     UChar* t = text(&length);
 
@@ -4789,6 +4826,28 @@ void CSSParser::recheckAtKeyword(const UChar* str, int len)
     // FIXME: Add CSS Variables if we ever decide to turn it back on.
 }
 
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+void CSSParser::replayBackgroundToken()
+{
+    // Leave m_data the way the scanner would have: the character after the
+    // previous token is put back and the current one is NUL terminated in
+    // place, so text() can unescape it just the same.
+    *yy_c_buf_p = yy_hold_char;
+    if (m_nextBackgroundToken == m_backgroundTokens->size()) {
+        yyTok = END_TOKEN;
+        return;
+    }
+
+    const CSSToken& token = m_backgroundTokens->at(m_nextBackgroundToken++);
+    yytext = m_data + token.offset;
+    yyleng = token.length;
+    yy_c_buf_p = yytext + yyleng;
+    yy_hold_char = *yy_c_buf_p;
+    *yy_c_buf_p = 0;
+    yyTok = token.type;
+}
+#endif
+
 UChar* CSSParser::text(int *length)
 {
     UChar* start = yytext;
@@ -5399,32 +5458,6 @@ int cssValueKeywordID(const CSSParserString& string)
 }
 
 #define YY_DECL int CSSParser::lex()
-#define yyconst const
-typedef int yy_state_type;
-typedef unsigned YY_CHAR;
-// The following line makes sure we treat non-Latin-1 Unicode characters correctly.
-#define YY_SC_TO_UI(c) (c > 0xff ? 0xff : c)
-#define YY_DO_BEFORE_ACTION \
-        yytext = yy_bp; \
-        yyleng = (int) (yy_cp - yy_bp); \
-        yy_hold_char = *yy_cp; \
-        *yy_cp = 0; \
-        yy_c_buf_p = yy_cp;
-#define YY_BREAK break;
-#define ECHO
-#define YY_RULE_SETUP
-#define INITIAL 0
-#define YY_STATE_EOF(state) (YY_END_OF_BUFFER + state + 1)
-#define yyterminate() yyTok = END_TOKEN; return yyTok
-#define YY_FATAL_ERROR(a)
-// The following line is needed to build the tokenizer with a condition stack.
-// The macro is used in the tokenizer grammar with lines containing
-// BEGIN(mediaqueries) and BEGIN(initial). yy_start acts as index to
-// tokenizer transition table, and 'mediaqueries' and 'initial' are
-// offset multipliers that specify which transitions are active
-// in the tokenizer during in each condition (tokenizer state).
-#define BEGIN yy_start = 1 + 2 *
-
-#include "tokenizer.cpp"
+#include "CSSFlexScanner.h"
 
 }
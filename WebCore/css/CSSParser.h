@@ -32,6 +32,7 @@
 
 namespace WebCore {
 
+    class BackgroundCSSTokenizer;
     class CSSMutableStyleDeclaration;
     class CSSPrimitiveValue;
     class CSSProperty;
@@ -64,6 +65,13 @@ namespace WebCore {
         bool parseDeclaration(CSSMutableStyleDeclaration*, const String&);
         bool parseMediaQuery(MediaList*, const String&);
 
+#ifdef ANDROID_INSTRUMENT
+        static unsigned parsedStyleSheetCount();
+        // Bytes saved in parsed style sheets by the values shared since
+        // CSSPrimitiveValue caches numbers and strings.
+        static size_t sharedValueSavings();
+#endif
+
         Document* document() const;
 
         void addProperty(int propId, PassRefPtr<CSSValue>, bool important);
@@ -243,6 +251,10 @@ namespace WebCore {
 
         void deleteFontFaceOnlyValues();
 
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+        void replayBackgroundToken();
+#endif
+
         UChar* m_data;
         UChar* yytext;
         UChar* yy_c_buf_p;
@@ -253,6 +265,13 @@ namespace WebCore {
         int yyTok;
         int yy_start;
 
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+        // Tokens scanned on a background thread for the sheet being parsed,
+        // replayed by lex() instead of running the scanner.
+        RefPtr<BackgroundCSSTokenizer> m_backgroundTokens;
+        size_t m_nextBackgroundToken;
+#endif
+
         bool m_allowImportRules;
         bool m_allowVariablesRules;
         bool m_allowNamespaceDeclarations;
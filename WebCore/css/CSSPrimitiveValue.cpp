@@ -33,6 +33,7 @@
 #include "RGBColor.h"
 #include "Rect.h"
 #include "RenderStyle.h"
+#include "StringHash.h"
 #include <wtf/ASCIICType.h>
 #include <wtf/StdLibExtras.h>
 
@@ -48,13 +49,22 @@ namespace WebCore {
 // non-refcounted simple type with value semantics. In practice these sharing tricks get similar memory benefits 
 // with less need for refactoring.
 
+#ifdef ANDROID_INSTRUMENT
+static unsigned numberAndStringCacheHitCount = 0;
+
+unsigned CSSPrimitiveValue::numberAndStringCacheHits()
+{
+    return numberAndStringCacheHitCount;
+}
+#endif
+
 PassRefPtr<CSSPrimitiveValue> CSSPrimitiveValue::createIdentifier(int ident)
 {
     static RefPtr<CSSPrimitiveValue>* identValueCache = new RefPtr<CSSPrimitiveValue>[numCSSValueKeywords];
     if (ident >= 0 && ident < numCSSValueKeywords) {
         RefPtr<CSSPrimitiveValue> primitiveValue = identValueCache[ident];
         if (!primitiveValue) {
-            primitiveValue = adoptRef(new CSSPrimitiveValue(ident));
+            primitiveValue = adoptRef(share(new CSSPrimitiveValue(ident)));
             identValueCache[ident] = primitiveValue;
         }
         return primitiveValue.release();
@@ -68,17 +78,17 @@ PassRefPtr<CSSPrimitiveValue> CSSPrimitiveValue::createColor(unsigned rgbValue)
     static ColorValueCache* colorValueCache = new ColorValueCache;
     // These are the empty and deleted values of the hash table.
     if (rgbValue == Color::transparent) {
-        static CSSPrimitiveValue* colorTransparent = new CSSPrimitiveValue(Color::transparent);
+        static CSSPrimitiveValue* colorTransparent = share(new CSSPrimitiveValue(Color::transparent));
         return colorTransparent;
     }
     if (rgbValue == Color::white) {
-        static CSSPrimitiveValue* colorWhite = new CSSPrimitiveValue(Color::white);
+        static CSSPrimitiveValue* colorWhite = share(new CSSPrimitiveValue(Color::white));
         return colorWhite;
     }
     RefPtr<CSSPrimitiveValue> primitiveValue = colorValueCache->get(rgbValue);
     if (primitiveValue)
         return primitiveValue.release();
-    primitiveValue = adoptRef(new CSSPrimitiveValue(rgbValue));
+    primitiveValue = adoptRef(share(new CSSPrimitiveValue(rgbValue)));
     // Just wipe out the cache and start rebuilding when it gets too big.
     const int maxColorCacheSize = 512;
     if (colorValueCache->size() >= maxColorCacheSize)
@@ -101,19 +111,69 @@ PassRefPtr<CSSPrimitiveValue> CSSPrimitiveValue::create(double value, UnitTypes
         if (value == intValue) {
             RefPtr<CSSPrimitiveValue> primitiveValue = integerValueCache[intValue][type];
             if (!primitiveValue) {
-                primitiveValue = adoptRef(new CSSPrimitiveValue(value, type));
+                primitiveValue = adoptRef(share(new CSSPrimitiveValue(value, type)));
                 integerValueCache[intValue][type] = primitiveValue;
             }
             return primitiveValue.release();
         }
     }
 
-    return adoptRef(new CSSPrimitiveValue(value, type));
+    // Other numbers, like 1.5em or 12pt, still repeat a lot across a style sheet.
+    if (type < CSS_NUMBER || type > CSS_KHZ)
+        return adoptRef(new CSSPrimitiveValue(value, type));
+    union {
+        double number;
+        unsigned long long bits;
+    } key;
+    key.number = value;
+    // These are the empty and deleted values of the hash table.
+    if (!key.bits || key.bits == static_cast<unsigned long long>(-1))
+        return adoptRef(new CSSPrimitiveValue(value, type));
+
+    typedef HashMap<unsigned long long, RefPtr<CSSPrimitiveValue> > NumberValueCache;
+    static NumberValueCache* numberValueCaches[CSS_KHZ + 1];
+    NumberValueCache*& numberValueCache = numberValueCaches[type];
+    if (!numberValueCache)
+        numberValueCache = new NumberValueCache;
+    RefPtr<CSSPrimitiveValue> primitiveValue = numberValueCache->get(key.bits);
+    if (primitiveValue) {
+#ifdef ANDROID_INSTRUMENT
+        ++numberAndStringCacheHitCount;
+#endif
+        return primitiveValue.release();
+    }
+    primitiveValue = adoptRef(share(new CSSPrimitiveValue(value, type)));
+    // Just wipe out the cache and start rebuilding when it gets too big.
+    const int maxNumberCacheSize = 256;
+    if (numberValueCache->size() >= maxNumberCacheSize)
+        numberValueCache->clear();
+    numberValueCache->add(key.bits, primitiveValue);
+    return primitiveValue.release();
 }
 
 PassRefPtr<CSSPrimitiveValue> CSSPrimitiveValue::create(const String& value, UnitTypes type)
 {
-    return adoptRef(new CSSPrimitiveValue(value, type));
+    // Strings and URLs repeat too, think of font family names and background images.
+    if ((type != CSS_STRING && type != CSS_URI) || value.isNull())
+        return adoptRef(new CSSPrimitiveValue(value, type));
+
+    typedef HashMap<String, RefPtr<CSSPrimitiveValue> > StringValueCache;
+    static StringValueCache* stringValueCache = new StringValueCache;
+    static StringValueCache* uriValueCache = new StringValueCache;
+    StringValueCache* cache = type == CSS_STRING ? stringValueCache : uriValueCache;
+    RefPtr<CSSPrimitiveValue> primitiveValue = cache->get(value);
+    if (primitiveValue) {
+#ifdef ANDROID_INSTRUMENT
+        ++numberAndStringCacheHitCount;
+#endif
+        return primitiveValue.release();
+    }
+    primitiveValue = adoptRef(share(new CSSPrimitiveValue(value, type)));
+    const int maxStringCacheSize = 256;
+    if (cache->size() >= maxStringCacheSize)
+        cache->clear();
+    cache->add(value, primitiveValue);
+    return primitiveValue.release();
 }
 
 static const char* valueOrPropertyName(int valueOrPropertyID)
@@ -477,6 +537,11 @@ void CSSPrimitiveValue::setFloatValue(unsigned short unitType, double floatValue
 {
     ec = 0;
 
+    if (isShared()) {
+        ec = NO_MODIFICATION_ALLOWED_ERR;
+        return;
+    }
+
     if (m_type < CSS_NUMBER || m_type > CSS_DIMENSION || unitType < CSS_NUMBER || unitType > CSS_DIMENSION) {
         ec = INVALID_ACCESS_ERR;
         return;
@@ -567,6 +632,11 @@ void CSSPrimitiveValue::setStringValue(unsigned short stringType, const String&
 {
     ec = 0;
 
+    if (isShared()) {
+        ec = NO_MODIFICATION_ALLOWED_ERR;
+        return;
+    }
+
     if (m_type < CSS_STRING || m_type > CSS_ATTR || stringType < CSS_STRING || stringType > CSS_ATTR) {
         ec = INVALID_ACCESS_ERR;
         return;
@@ -98,6 +98,12 @@ public:
         return adoptRef(new CSSPrimitiveValue(value));
     }
 
+#ifdef ANDROID_INSTRUMENT
+    // Values that the number and string caches of the create functions above
+    // handed out again instead of allocating new ones.
+    static unsigned numberAndStringCacheHits();
+#endif
+
     virtual ~CSSPrimitiveValue();
 
     void cleanup();
@@ -187,6 +193,9 @@ private:
     template<typename T> CSSPrimitiveValue(T* val) { init(PassRefPtr<T>(val)); }
     template<typename T> CSSPrimitiveValue(PassRefPtr<T> val) { init(val); }
 
+    // Marks a value that the create functions keep and hand out to every caller.
+    static CSSPrimitiveValue* share(CSSPrimitiveValue* value) { value->setShared(); return value; }
+
     static void create(int); // compile-time guard
     static void create(unsigned); // compile-time guard
     template<typename T> operator T*(); // compile-time guard
@@ -114,6 +114,10 @@
 #include <qwebhistoryinterface.h>
 #endif
 
+#ifdef ANDROID_INSTRUMENT
+#include "StyleRecalcStatistics.h"
+#endif
+
 using namespace std;
 
 namespace WebCore {
@@ -366,13 +370,41 @@ public:
     CSSRuleDataList* getClassRules(AtomicStringImpl* key) { m_classRules.checkConsistency(); return m_classRules.get(key); }
     CSSRuleDataList* getTagRules(AtomicStringImpl* key) { m_tagRules.checkConsistency(); return m_tagRules.get(key); }
     CSSRuleDataList* getUniversalRules() { return m_universalRules; }
-    
+
+    // The rules one top-level sheet added to the maps. Keys are kept rather than looked up
+    // again from the selectors, which may already be gone when a modified sheet is removed.
+    struct PartitionRule {
+        CSSRuleData* ruleData;
+        AtomRuleMap* map; // 0 for the universal rules.
+        AtomicStringImpl* key;
+    };
+    struct SheetPartition : Noncopyable {
+        RefPtr<CSSStyleSheet> sheet;
+        unsigned modificationCount;
+        Vector<PartitionRule> rules;
+        // @font-face, @-webkit-keyframes and @-webkit-variables rules register with the style
+        // selector itself, so a sheet with any of them cannot be removed on its own.
+        bool hasGlobalRules;
+    };
+
+    SheetPartition* collectPartition(CSSStyleSheet*, const MediaQueryEvaluator&, CSSStyleSelector*);
+    void addPartitionFromSheet(CSSStyleSheet*, const MediaQueryEvaluator&, CSSStyleSelector*);
+    void removePartitionRules(SheetPartition*);
+    void renumberPartitions();
+    void didAddGlobalRule()
+    {
+        if (m_currentPartition)
+            m_currentPartition->hasGlobalRules = true;
+    }
+
 public:
     AtomRuleMap m_idRules;
     AtomRuleMap m_classRules;
     AtomRuleMap m_tagRules;
     CSSRuleDataList* m_universalRules;
     unsigned m_ruleCount;
+    Vector<SheetPartition*> m_partitions;
+    SheetPartition* m_currentPartition;
 };
 
 static CSSRuleSet* defaultStyle;
@@ -385,6 +417,8 @@ RenderStyle* CSSStyleSelector::s_styleNotYetAvailable;
 
 static PseudoState pseudoState;
 
+static CSSStyleSelector::StyleSharingStatistics styleSharingStats;
+
 static void loadFullDefaultStyle();
 static void loadSimpleDefaultStyle();
 // FIXME: It would be nice to use some mechanism that guarantees this is in sync with the real UA stylesheet.
@@ -407,6 +441,20 @@ static const MediaQueryEvaluator& printEval()
     return staticPrintEval;
 }
 
+static void collectAuthorStyleSheets(CSSStyleSheet* mappedElementSheet, StyleSheetList* styleSheets, Vector<CSSStyleSheet*>& sheets)
+{
+    // Add rules from elements like SVG's <font-face>
+    if (mappedElementSheet)
+        sheets.append(mappedElementSheet);
+
+    unsigned length = styleSheets->length();
+    for (unsigned i = 0; i < length; i++) {
+        StyleSheet* sheet = styleSheets->item(i);
+        if (sheet->isCSSStyleSheet() && !sheet->disabled())
+            sheets.append(static_cast<CSSStyleSheet*>(sheet));
+    }
+}
+
 CSSStyleSelector::CSSStyleSelector(Document* doc, StyleSheetList* styleSheets, CSSStyleSheet* mappedElementSheet,
                                    CSSStyleSheet* pageUserSheet, const Vector<RefPtr<CSSStyleSheet> >* pageGroupUserSheets,
                                    bool strictParsing, bool matchAuthorAndUserStyles)
@@ -463,22 +511,131 @@ CSSStyleSelector::CSSStyleSelector(Document* doc, StyleSheetList* styleSheets, C
 
     // add stylesheets from document
     m_authorStyle = new CSSRuleSet();
-    
-    // Add rules from elements like SVG's <font-face>
-    if (mappedElementSheet)
-        m_authorStyle->addRulesFromSheet(mappedElementSheet, *m_medium, this);
+    Vector<CSSStyleSheet*> authorSheets;
+    collectAuthorStyleSheets(mappedElementSheet, styleSheets, authorSheets);
+    for (size_t i = 0; i < authorSheets.size(); ++i)
+        m_authorStyle->addPartitionFromSheet(authorSheets[i], *m_medium, this);
+
 
-    unsigned length = styleSheets->length();
-    for (unsigned i = 0; i < length; i++) {
-        StyleSheet* sheet = styleSheets->item(i);
-        if (sheet->isCSSStyleSheet() && !sheet->disabled())
-            m_authorStyle->addRulesFromSheet(static_cast<CSSStyleSheet*>(sheet), *m_medium, this);
-    }
-    
     if (doc->renderer() && doc->renderer()->style())
         doc->renderer()->style()->font().update(fontSelector());
 }
 
+namespace {
+
+// The ids, classes and tags keying the rules that were added or removed, which are
+// the only things an element needs to have for those rules to apply to it.
+struct ChangedRuleKeys {
+    ChangedRuleKeys() : hasUniversalRules(false) { }
+
+    void add(CSSRuleSet* ruleSet, const CSSRuleSet::SheetPartition* partition)
+    {
+        size_t size = partition->rules.size();
+        for (size_t i = 0; i < size; ++i) {
+            const CSSRuleSet::PartitionRule& rule = partition->rules[i];
+            if (rule.map == &ruleSet->m_idRules)
+                ids.add(rule.key);
+            else if (rule.map == &ruleSet->m_classRules)
+                classes.add(rule.key);
+            else if (rule.map == &ruleSet->m_tagRules)
+                tags.add(rule.key);
+            else
+                hasUniversalRules = true;
+        }
+    }
+
+    bool matches(Element* element) const
+    {
+        if (hasUniversalRules || tags.contains(element->localName().impl()))
+            return true;
+        if (element->hasID() && ids.contains(element->getIDAttribute().impl()))
+            return true;
+        if (element->hasClass() && !classes.isEmpty()) {
+            const SpaceSplitString& classNames = static_cast<StyledElement*>(element)->classNames();
+            size_t size = classNames.size();
+            for (size_t i = 0; i < size; ++i) {
+                if (classes.contains(classNames[i].impl()))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    bool isEmpty() const { return !hasUniversalRules && ids.isEmpty() && classes.isEmpty() && tags.isEmpty(); }
+
+    HashSet<AtomicStringImpl*> ids;
+    HashSet<AtomicStringImpl*> classes;
+    HashSet<AtomicStringImpl*> tags;
+    bool hasUniversalRules;
+};
+
+} // namespace
+
+bool CSSStyleSelector::updateAuthorStyleSheets(CSSStyleSheet* mappedElementSheet, StyleSheetList* styleSheets)
+{
+    Vector<CSSStyleSheet*> sheets;
+    collectAuthorStyleSheets(mappedElementSheet, styleSheets, sheets);
+
+    // Partitions of unchanged sheets are kept, in whatever position the sheet has now.
+    Vector<CSSRuleSet::SheetPartition*>& partitions = m_authorStyle->m_partitions;
+    HashMap<CSSStyleSheet*, CSSRuleSet::SheetPartition*> unchangedPartitions;
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        CSSRuleSet::SheetPartition* partition = partitions[i];
+        if (partition->modificationCount == partition->sheet->modificationCount())
+            unchangedPartitions.add(partition->sheet.get(), partition);
+    }
+
+    Vector<CSSRuleSet::SheetPartition*> newPartitions(sheets.size());
+    HashSet<CSSRuleSet::SheetPartition*> keptPartitions;
+    for (size_t i = 0; i < sheets.size(); ++i) {
+        newPartitions[i] = unchangedPartitions.take(sheets[i]);
+        if (newPartitions[i])
+            keptPartitions.add(newPartitions[i]);
+    }
+
+    Vector<CSSRuleSet::SheetPartition*> removedPartitions;
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        if (!keptPartitions.contains(partitions[i])) {
+            if (partitions[i]->hasGlobalRules)
+                return false;
+            removedPartitions.append(partitions[i]);
+        }
+    }
+
+    ChangedRuleKeys changedKeys;
+    for (size_t i = 0; i < removedPartitions.size(); ++i) {
+        changedKeys.add(m_authorStyle, removedPartitions[i]);
+        m_authorStyle->removePartitionRules(removedPartitions[i]);
+        delete removedPartitions[i];
+    }
+    partitions.swap(newPartitions);
+
+    // Returning false makes the document throw this style selector away, so the
+    // partially updated rule set is never matched against.
+    for (size_t i = 0; i < sheets.size(); ++i) {
+        if (partitions[i])
+            continue;
+        partitions[i] = m_authorStyle->collectPartition(sheets[i], *m_medium, this);
+        if (partitions[i]->hasGlobalRules)
+            return false;
+        changedKeys.add(m_authorStyle, partitions[i]);
+    }
+    m_authorStyle->renumberPartitions();
+
+    if (changedKeys.isEmpty())
+        return true;
+
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::StyleSheetChange);
+#endif
+    Document* document = m_checker.m_document;
+    for (Node* node = document; node; node = node->traverseNextNode()) {
+        if (node->isElementNode() && changedKeys.matches(static_cast<Element*>(node)))
+            node->setNeedsStyleRecalc();
+    }
+    return true;
+}
+
 // This is a simplified style setting function for keyframe styles
 void CSSStyleSelector::addKeyframeStyle(PassRefPtr<WebKitCSSKeyframesRule> rule)
 {
@@ -697,11 +854,18 @@ void CSSStyleSelector::matchRulesForList(CSSRuleDataList* rules, int& firstRuleI
     if (!rules)
         return;
 
+    // The ancestor filter can only be trusted when it holds exactly the ancestors of this element.
+    bool canUseFastReject = !m_parentStack.isEmpty() && m_parentStack.last().element == m_element->parentNode();
+
     for (CSSRuleData* d = rules->first(); d; d = d->next()) {
         CSSStyleRule* rule = d->rule();
         const AtomicString& localName = m_element->localName();
         const AtomicString& selectorLocalName = d->selector()->m_tag.localName();
-        if ((localName == selectorLocalName || selectorLocalName == starAtom) && checkSelector(d->selector())) {
+        if (localName != selectorLocalName && selectorLocalName != starAtom)
+            continue;
+        if (canUseFastReject && fastRejectSelector(d))
+            continue;
+        if (checkSelector(d->selector())) {
             // If the rule has no properties to apply, then ignore it.
             CSSMutableStyleDeclaration* decl = rule->declaration();
             if (!decl || !decl->length())
@@ -727,6 +891,91 @@ void CSSStyleSelector::matchRulesForList(CSSRuleDataList* rules, int& firstRuleI
     }
 }
 
+inline bool CSSStyleSelector::fastRejectSelector(CSSRuleData* ruleData) const
+{
+    const unsigned* hashes = ruleData->descendantSelectorIdentifierHashes();
+    for (unsigned i = 0; i < CSSRuleData::maximumIdentifierCount && hashes[i]; ++i) {
+        if (!m_ancestorIdentifierFilter.mayContain(hashes[i]))
+            return true;
+    }
+    return false;
+}
+
+static inline void collectElementIdentifierHashes(Element* element, Vector<unsigned, 4>& identifierHashes)
+{
+    identifierHashes.append(element->localName().impl()->hash());
+    if (element->hasID()) {
+        const AtomicString& id = element->getIDAttribute();
+        if (!id.isEmpty())
+            identifierHashes.append(id.impl()->hash());
+    }
+    if (element->hasClass()) {
+        const SpaceSplitString& classNames = static_cast<StyledElement*>(element)->classNames();
+        size_t count = classNames.size();
+        for (size_t i = 0; i < count; ++i)
+            identifierHashes.append(classNames[i].impl()->hash());
+    }
+}
+
+void CSSStyleSelector::pushParentStackFrame(Element* parent, bool pushedImplicitly)
+{
+    m_parentStack.append(ParentStackFrame(parent, pushedImplicitly));
+    Vector<unsigned, 4>& identifierHashes = m_parentStack.last().identifierHashes;
+    collectElementIdentifierHashes(parent, identifierHashes);
+    size_t count = identifierHashes.size();
+    for (size_t i = 0; i < count; ++i)
+        m_ancestorIdentifierFilter.add(identifierHashes[i]);
+}
+
+void CSSStyleSelector::popParentStackFrame()
+{
+    ASSERT(!m_parentStack.isEmpty());
+    const Vector<unsigned, 4>& identifierHashes = m_parentStack.last().identifierHashes;
+    size_t count = identifierHashes.size();
+    for (size_t i = 0; i < count; ++i)
+        m_ancestorIdentifierFilter.remove(identifierHashes[i]);
+    m_parentStack.removeLast();
+}
+
+void CSSStyleSelector::pushParent(Element* parent)
+{
+    ASSERT(parent);
+    Node* grandParent = parent->parentNode();
+    if (!m_parentStack.isEmpty() && m_parentStack.last().element == grandParent) {
+        pushParentStackFrame(parent, false);
+        return;
+    }
+
+    // We are not always invoked in tree order; style can be resolved for a subtree
+    // that is attached in the middle of parsing, for instance. Rebuild the stack
+    // from the root in that case.
+    m_parentStack.clear();
+    m_ancestorIdentifierFilter.clear();
+    m_styleSharingCache.clear();
+    Vector<Element*, 32> ancestors;
+    for (Node* ancestor = grandParent; ancestor && ancestor->isElementNode(); ancestor = ancestor->parentNode())
+        ancestors.append(static_cast<Element*>(ancestor));
+    for (size_t i = ancestors.size(); i; --i)
+        pushParentStackFrame(ancestors[i - 1], true);
+    pushParentStackFrame(parent, false);
+}
+
+void CSSStyleSelector::popParent(Element* parent)
+{
+    if (m_parentStack.isEmpty() || m_parentStack.last().element != parent)
+        return;
+    popParentStackFrame();
+
+    // Ancestors added by a rebuild have no matching popParent() call, so drop
+    // them once the element that caused the rebuild is done.
+    if (!m_parentStack.isEmpty() && m_parentStack.last().pushedImplicitly) {
+        m_parentStack.clear();
+        m_ancestorIdentifierFilter.clear();
+    }
+    if (m_parentStack.isEmpty())
+        m_styleSharingCache.clear();
+}
+
 static bool operator >(CSSRuleData& r1, CSSRuleData& r2)
 {
     int spec1 = r1.selector()->specificity();
@@ -1093,6 +1342,98 @@ RenderStyle* CSSStyleSelector::locateSharedStyle()
     return 0;
 }
 
+// The style an element inherits from, if it is one that elements elsewhere in the tree
+// can only have when their ancestors are equivalent. The parent conditions are the
+// ones locateCousinList() applies.
+static RenderStyle* parentStyleForSharing(Element* element)
+{
+    Node* parent = element->parentNode();
+    if (!parent || !parent->isStyledElement())
+        return 0;
+    StyledElement* parentElement = static_cast<StyledElement*>(parent);
+    if (parentElement->inlineStyleDecl() || parentElement->hasID())
+        return 0;
+    RenderStyle* parentStyle = parentElement->renderStyle();
+    if (parentStyle == CSSStyleSelector::styleNotYetAvailable())
+        return 0;
+    return parentStyle;
+}
+
+static unsigned mappedAttributeFingerprint(StyledElement* element)
+{
+    if (!element->hasMappedAttributes())
+        return 0;
+    // Summed so that the order of the attributes does not matter.
+    unsigned fingerprint = 0;
+    const NamedMappedAttrMap* map = element->mappedAttributes();
+    for (unsigned i = 0; i < map->length(); i++) {
+        Attribute* attr = map->attributeItem(i);
+        if (attr->isMappedAttribute() && static_cast<MappedAttribute*>(attr)->decl())
+            fingerprint += PtrHash<AtomicStringImpl*>::hash(attr->name().localName().impl()) ^ PtrHash<AtomicStringImpl*>::hash(attr->value().impl());
+    }
+    return fingerprint;
+}
+
+RenderStyle* CSSStyleSelector::locateSharedStyleInCache()
+{
+    if (m_parentStack.isEmpty() || m_styleSharingCache.isEmpty() || !m_styledElement)
+        return 0;
+
+    if (m_styledElement->inlineStyleDecl() || m_styledElement->hasID() || m_styledElement->document()->usesSiblingRules())
+        return 0;
+
+    RenderStyle* parentStyle = parentStyleForSharing(m_element);
+    if (!parentStyle)
+        return 0;
+
+    AtomicStringImpl* localName = m_element->localName().impl();
+    AtomicStringImpl* className = m_element->hasClass() ? m_element->getAttribute(classAttr).impl() : 0;
+    unsigned attributeFingerprint = mappedAttributeFingerprint(m_styledElement);
+
+    size_t size = m_styleSharingCache.size();
+    for (size_t i = 0; i < size; ++i) {
+        StyleSharingCandidate candidate = m_styleSharingCache[i];
+        if (candidate.parentStyle != parentStyle || candidate.localName != localName || candidate.className != className || candidate.attributeFingerprint != attributeFingerprint)
+            continue;
+        Element* element = candidate.element;
+        if (element == m_element || element->needsStyleRecalc() || parentStyleForSharing(element) != parentStyle || !canShareStyleWithElement(element))
+            continue;
+        if (i) {
+            m_styleSharingCache.remove(i);
+            m_styleSharingCache.insert(0, candidate);
+        }
+        return element->renderStyle();
+    }
+    return 0;
+}
+
+void CSSStyleSelector::addToStyleSharingCache()
+{
+    if (m_parentStack.isEmpty() || !m_styledElement || m_style->unique())
+        return;
+
+    if (m_styledElement->inlineStyleDecl() || m_styledElement->hasID() || m_styledElement->document()->usesSiblingRules())
+        return;
+
+    StyleSharingCandidate candidate;
+    candidate.parentStyle = parentStyleForSharing(m_element);
+    if (!candidate.parentStyle)
+        return;
+    candidate.element = m_element;
+    candidate.localName = m_element->localName().impl();
+    candidate.className = m_element->hasClass() ? m_element->getAttribute(classAttr).impl() : 0;
+    candidate.attributeFingerprint = mappedAttributeFingerprint(m_styledElement);
+
+    if (m_styleSharingCache.size() == styleSharingCacheSize)
+        m_styleSharingCache.removeLast();
+    m_styleSharingCache.insert(0, candidate);
+}
+
+const CSSStyleSelector::StyleSharingStatistics& CSSStyleSelector::styleSharingStatistics()
+{
+    return styleSharingStats;
+}
+
 void CSSStyleSelector::matchUARules(int& firstUARule, int& lastUARule)
 {
     // First we match rules from the user agent sheet.
@@ -1149,6 +1490,9 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForDocument(Document* document)
 
 PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyle* defaultParent, bool allowSharing, bool resolveForRootDefault)
 {
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::ResolutionTimer statisticsTimer;
+#endif
     // Once an element has a renderer, we don't try to destroy it, since otherwise the renderer
     // will vanish if a style recalc happens during loading.
     if (allowSharing && !e->document()->haveStylesheetsLoaded() && !e->renderer()) {
@@ -1165,9 +1509,17 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
 
     initElementAndPseudoState(e);
     if (allowSharing) {
-        RenderStyle* sharedStyle = locateSharedStyle();
-        if (sharedStyle)
+        if (RenderStyle* sharedStyle = locateSharedStyle()) {
+            ++styleSharingStats.siblingHits;
             return sharedStyle;
+        }
+        if (!defaultParent) {
+            if (RenderStyle* sharedStyle = locateSharedStyleInCache()) {
+                ++styleSharingStats.cacheHits;
+                return sharedStyle;
+            }
+        }
+        ++styleSharingStats.misses;
     }
     initForStyleResolve(e, defaultParent);
 
@@ -1339,6 +1691,9 @@ PassRefPtr<RenderStyle> CSSStyleSelector::styleForElement(Element* e, RenderStyl
     if (m_style->hasPseudoStyle(FIRST_LETTER))
         m_style->setUnique();
 
+    if (allowSharing && !defaultParent && !resolveForRootDefault)
+        addToStyleSharingCache();
+
     // Now return the style.
     return m_style.release();
 }
@@ -2764,6 +3119,7 @@ CSSRuleSet::CSSRuleSet()
 {
     m_universalRules = 0;
     m_ruleCount = 0;
+    m_currentPartition = 0;
 }
 
 CSSRuleSet::~CSSRuleSet()
@@ -2773,8 +3129,112 @@ CSSRuleSet::~CSSRuleSet()
     deleteAllValues(m_tagRules);
 
     delete m_universalRules; 
+    deleteAllValues(m_partitions);
+}
+
+CSSRuleSet::SheetPartition* CSSRuleSet::collectPartition(CSSStyleSheet* sheet, const MediaQueryEvaluator& medium, CSSStyleSelector* styleSelector)
+{
+    SheetPartition* partition = new SheetPartition;
+    partition->sheet = sheet;
+    partition->modificationCount = sheet->modificationCount();
+    partition->hasGlobalRules = false;
+
+    m_currentPartition = partition;
+    addRulesFromSheet(sheet, medium, styleSelector);
+    m_currentPartition = 0;
+    return partition;
+}
+
+void CSSRuleSet::addPartitionFromSheet(CSSStyleSheet* sheet, const MediaQueryEvaluator& medium, CSSStyleSelector* styleSelector)
+{
+    m_partitions.append(collectPartition(sheet, medium, styleSelector));
+}
+
+void CSSRuleSet::removePartitionRules(SheetPartition* partition)
+{
+    HashSet<CSSRuleData*> removedRules;
+    size_t size = partition->rules.size();
+    for (size_t i = 0; i < size; ++i)
+        removedRules.add(partition->rules[i].ruleData);
+
+    for (size_t i = 0; i < size; ++i) {
+        const PartitionRule& rule = partition->rules[i];
+        if (!rule.map) {
+            if (m_universalRules && m_universalRules->removeRules(removedRules)) {
+                delete m_universalRules;
+                m_universalRules = 0;
+            }
+            continue;
+        }
+        AtomRuleMap::iterator it = rule.map->find(rule.key);
+        if (it != rule.map->end() && it->second->removeRules(removedRules)) {
+            delete it->second;
+            rule.map->remove(it);
+        }
+    }
+    partition->rules.clear();
+}
+
+void CSSRuleSet::renumberPartitions()
+{
+    // Positions only decide the cascade order between rules, so they just need to follow
+    // the order of the sheets and of the rules within each sheet.
+    m_ruleCount = 0;
+    size_t partitionCount = m_partitions.size();
+    for (size_t i = 0; i < partitionCount; ++i) {
+        Vector<PartitionRule>& rules = m_partitions[i]->rules;
+        size_t size = rules.size();
+        for (size_t j = 0; j < size; ++j)
+            rules[j].ruleData->setPosition(m_ruleCount++);
+    }
+}
+
+static inline void collectDescendantSelectorIdentifierHash(CSSSelector* selector, unsigned*& hash, unsigned* end)
+{
+    // A compound selector keeps its tag on the same CSSSelector as its first id or class.
+    const AtomicString& localName = selector->m_tag.localName();
+    if (localName != starAtom)
+        *hash++ = localName.impl()->hash();
+    if (hash == end)
+        return;
+    if ((selector->m_match == CSSSelector::Id || selector->m_match == CSSSelector::Class) && !selector->m_value.isEmpty())
+        *hash++ = selector->m_value.impl()->hash();
 }
 
+void CSSRuleData::collectDescendantSelectorIdentifierHashes()
+{
+    unsigned* hash = m_descendantSelectorIdentifierHashes;
+    unsigned* end = hash + maximumIdentifierCount;
+
+    // The rightmost compound selector matches the element itself and is already
+    // covered by the rule maps, so only look at what has to match an ancestor.
+    // Anything reached through a sibling combinator matches a sibling of the
+    // element or of an ancestor, not an ancestor, until the next child or
+    // descendant combinator.
+    CSSSelector::Relation relation = m_selector->relation();
+    bool skipOverSubselectors = true;
+    for (CSSSelector* selector = m_selector->tagHistory(); selector; selector = selector->tagHistory()) {
+        switch (relation) {
+        case CSSSelector::SubSelector:
+            if (!skipOverSubselectors)
+                collectDescendantSelectorIdentifierHash(selector, hash, end);
+            break;
+        case CSSSelector::DirectAdjacent:
+        case CSSSelector::IndirectAdjacent:
+            skipOverSubselectors = true;
+            break;
+        case CSSSelector::Descendant:
+        case CSSSelector::Child:
+            skipOverSubselectors = false;
+            collectDescendantSelectorIdentifierHash(selector, hash, end);
+            break;
+        }
+        if (hash == end)
+            return;
+        relation = selector->relation();
+    }
+    *hash = 0;
+}
 
 void CSSRuleSet::addToRuleSet(AtomicStringImpl* key, AtomRuleMap& map,
                               CSSStyleRule* rule, CSSSelector* sel)
@@ -2786,6 +3246,11 @@ void CSSRuleSet::addToRuleSet(AtomicStringImpl* key, AtomRuleMap& map,
         map.set(key, rules);
     } else
         rules->append(m_ruleCount++, rule, sel);
+
+    if (m_currentPartition) {
+        PartitionRule partitionRule = { rules->last(), &map, key };
+        m_currentPartition->rules.append(partitionRule);
+    }
 }
 
 void CSSRuleSet::addRule(CSSStyleRule* rule, CSSSelector* sel)
@@ -2810,6 +3275,11 @@ void CSSRuleSet::addRule(CSSStyleRule* rule, CSSSelector* sel)
         m_universalRules = new CSSRuleDataList(m_ruleCount++, rule, sel);
     else
         m_universalRules->append(m_ruleCount++, rule, sel);
+
+    if (m_currentPartition) {
+        PartitionRule partitionRule = { m_universalRules->last(), 0, 0 };
+        m_currentPartition->rules.append(partitionRule);
+    }
 }
 
 void CSSRuleSet::addRulesFromSheet(CSSStyleSheet* sheet, const MediaQueryEvaluator& medium, CSSStyleSelector* styleSelector)
@@ -2853,9 +3323,11 @@ void CSSRuleSet::addRulesFromSheet(CSSStyleSheet* sheet, const MediaQueryEvaluat
                         // Add this font face to our set.
                         const CSSFontFaceRule* fontFaceRule = static_cast<CSSFontFaceRule*>(childItem);
                         styleSelector->fontSelector()->addFontFaceRule(fontFaceRule);
+                        didAddGlobalRule();
                     } else if (childItem->isKeyframesRule() && styleSelector) {
                         // Add this keyframe rule to our set.
                         styleSelector->addKeyframeStyle(static_cast<WebKitCSSKeyframesRule*>(childItem));
+                        didAddGlobalRule();
                     }
                 }   // for rules
             }   // if rules
@@ -2863,13 +3335,18 @@ void CSSRuleSet::addRulesFromSheet(CSSStyleSheet* sheet, const MediaQueryEvaluat
             // Add this font face to our set.
             const CSSFontFaceRule* fontFaceRule = static_cast<CSSFontFaceRule*>(item);
             styleSelector->fontSelector()->addFontFaceRule(fontFaceRule);
+            didAddGlobalRule();
         } else if (item->isVariablesRule()) {
             // Evaluate the media query and make sure it matches.
             CSSVariablesRule* variables = static_cast<CSSVariablesRule*>(item);
-            if (!variables->media() || medium.eval(variables->media(), styleSelector))
+            if (!variables->media() || medium.eval(variables->media(), styleSelector)) {
                 styleSelector->addVariables(variables);
-        } else if (item->isKeyframesRule())
+                didAddGlobalRule();
+            }
+        } else if (item->isKeyframesRule()) {
             styleSelector->addKeyframeStyle(static_cast<WebKitCSSKeyframesRule*>(item));
+            didAddGlobalRule();
+        }
     }
 }
 
@@ -6092,6 +6569,9 @@ void CSSStyleSelector::SelectorChecker::allVisitedStateChanged()
 {
     if (m_linksCheckedForVisitedState.isEmpty())
         return;
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::PseudoStateChange);
+#endif
     for (Node* node = m_document; node; node = node->traverseNextNode()) {
         if (node->isLink())
             node->setNeedsStyleRecalc();
@@ -6102,6 +6582,9 @@ void CSSStyleSelector::SelectorChecker::visitedStateChanged(LinkHash visitedHash
 {
     if (!m_linksCheckedForVisitedState.contains(visitedHash))
         return;
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::PseudoStateChange);
+#endif
     for (Node* node = m_document; node; node = node->traverseNextNode()) {
         const AtomicString* attr = linkAttribute(node);
         if (attr && visitedLinkHash(m_document->baseURL(), *attr) == visitedHash)
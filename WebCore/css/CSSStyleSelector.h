@@ -27,6 +27,7 @@
 #include "MediaQueryExp.h"
 #include "RenderStyle.h"
 #include "StringHash.h"
+#include <wtf/BloomFilter.h>
 #include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
 #include <wtf/RefPtr.h>
@@ -94,16 +95,35 @@ public:
 
         static PassRefPtr<RenderStyle> styleForDocument(Document*);
 
+        // Brings the author rules up to date with the given sheets, collecting only the sheets
+        // that were added or modified and marking the elements the added or removed rules can
+        // match. Returns false if the style selector has to be rebuilt instead.
+        bool updateAuthorStyleSheets(CSSStyleSheet* mappedElementSheet, StyleSheetList* styleSheets);
+
+        // Called around style resolution of an element's children, so that rules with
+        // descendant and child combinators can be rejected using the ancestor filter.
+        void pushParent(Element*);
+        void popParent(Element*);
+
 #if ENABLE(DATAGRID)
         // Datagrid style computation (uses unique pseudo elements and structures)
         PassRefPtr<RenderStyle> pseudoStyleForDataGridColumn(DataGridColumn*, RenderStyle* parentStyle);
         PassRefPtr<RenderStyle> pseudoStyleForDataGridColumnHeader(DataGridColumn*, RenderStyle* parentStyle);
 #endif
 
+        struct StyleSharingStatistics {
+            unsigned siblingHits;
+            unsigned cacheHits;
+            unsigned misses;
+        };
+        static const StyleSharingStatistics& styleSharingStatistics();
+
     private:
         RenderStyle* locateSharedStyle();
         Node* locateCousinList(Element* parent, unsigned& visitedNodes);
         bool canShareStyleWithElement(Node*);
+        RenderStyle* locateSharedStyleInCache();
+        void addToStyleSharingCache();
 
         RenderStyle* style() const { return m_style.get(); }
 
@@ -175,6 +195,10 @@ public:
         void matchRulesForList(CSSRuleDataList*, int& firstRuleIndex, int& lastRuleIndex);
         void sortMatchedRules(unsigned start, unsigned end);
 
+        void pushParentStackFrame(Element*, bool pushedImplicitly);
+        void popParentStackFrame();
+        bool fastRejectSelector(CSSRuleData*) const;
+
         void applyDeclarations(bool firstPass, bool important, int startIndex, int endIndex);
         
         CSSRuleSet* m_authorStyle;
@@ -286,6 +310,32 @@ public:
         
         HashMap<String, CSSVariablesRule*> m_variablesMap;
         HashMap<CSSMutableStyleDeclaration*, RefPtr<CSSMutableStyleDeclaration> > m_resolvedVariablesDeclarations;
+
+        // The elements whose children are being resolved, from the root down, with the
+        // tag, id and class hashes each one added to m_ancestorIdentifierFilter.
+        struct ParentStackFrame {
+            ParentStackFrame() : element(0), pushedImplicitly(false) { }
+            ParentStackFrame(Element* element, bool pushedImplicitly) : element(element), pushedImplicitly(pushedImplicitly) { }
+            Element* element;
+            Vector<unsigned, 4> identifierHashes;
+            // Ancestors added when the stack was rebuilt, not by a pushParent() of their own.
+            bool pushedImplicitly;
+        };
+        Vector<ParentStackFrame> m_parentStack;
+        BloomFilter<12> m_ancestorIdentifierFilter;
+
+        // Recently resolved elements, most recent first, whose styles may be shared by
+        // elements anywhere else in the tree with the same parent style. Emptied whenever
+        // m_parentStack is, so it never outlives the recalc or attach that filled it.
+        struct StyleSharingCandidate {
+            Element* element;
+            RenderStyle* parentStyle;
+            AtomicStringImpl* localName;
+            AtomicStringImpl* className;
+            unsigned attributeFingerprint;
+        };
+        static const size_t styleSharingCacheSize = 32;
+        Vector<StyleSharingCandidate, styleSharingCacheSize> m_styleSharingCache;
     };
 
     class CSSRuleData : public Noncopyable {
@@ -298,6 +348,7 @@ public:
         {
             if (prev)
                 prev->m_next = this;
+            collectDescendantSelectorIdentifierHashes();
         }
 
         ~CSSRuleData() 
@@ -305,15 +356,26 @@ public:
         }
 
         unsigned position() { return m_position; }
+        void setPosition(unsigned position) { m_position = position; }
         CSSStyleRule* rule() { return m_rule; }
         CSSSelector* selector() { return m_selector; }
         CSSRuleData* next() { return m_next; }
 
+        // Hashes of tag names, ids and classes that some ancestor must have for the
+        // selector to match, terminated by 0 when there are fewer than the maximum.
+        static const unsigned maximumIdentifierCount = 4;
+        const unsigned* descendantSelectorIdentifierHashes() const { return m_descendantSelectorIdentifierHashes; }
+
     private:
+        friend class CSSRuleDataList;
+
+        void collectDescendantSelectorIdentifierHashes();
+
         unsigned m_position;
         CSSStyleRule* m_rule;
         CSSSelector* m_selector;
         CSSRuleData* m_next;
+        unsigned m_descendantSelectorIdentifierHashes[maximumIdentifierCount];
     };
 
     class CSSRuleDataList : public Noncopyable {
@@ -341,6 +403,27 @@ public:
 
         void append(unsigned pos, CSSStyleRule* rule, CSSSelector* sel) { m_last = new CSSRuleData(pos, rule, sel, m_last); }
 
+        // Deletes the given rules, returning true if none are left.
+        bool removeRules(const HashSet<CSSRuleData*>& rules)
+        {
+            CSSRuleData* previous = 0;
+            CSSRuleData* ptr = m_first;
+            while (ptr) {
+                CSSRuleData* next = ptr->next();
+                if (rules.contains(ptr)) {
+                    if (previous)
+                        previous->m_next = next;
+                    else
+                        m_first = next;
+                    delete ptr;
+                } else
+                    previous = ptr;
+                ptr = next;
+            }
+            m_last = previous;
+            return !m_first;
+        }
+
     private:
         CSSRuleData* m_first;
         CSSRuleData* m_last;
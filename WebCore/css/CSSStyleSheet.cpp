@@ -39,6 +39,7 @@ CSSStyleSheet::CSSStyleSheet(CSSStyleSheet* parentSheet, const String& href, con
     , m_doc(parentSheet ? parentSheet->doc() : 0)
     , m_namespaces(0)
     , m_charset(charset)
+    , m_modificationCount(0)
     , m_loadCompleted(false)
     , m_strictParsing(!parentSheet || parentSheet->useStrictParsing())
     , m_isUserStyleSheet(parentSheet ? parentSheet->isUserStyleSheet() : false)
@@ -51,6 +52,7 @@ CSSStyleSheet::CSSStyleSheet(Node* parentNode, const String& href, const KURL& b
     , m_doc(parentNode->document())
     , m_namespaces(0)
     , m_charset(charset)
+    , m_modificationCount(0)
     , m_loadCompleted(false)
     , m_strictParsing(false)
     , m_isUserStyleSheet(false)
@@ -62,6 +64,7 @@ CSSStyleSheet::CSSStyleSheet(CSSRule* ownerRule, const String& href, const KURL&
     : StyleSheet(ownerRule, href, baseURL)
     , m_namespaces(0)
     , m_charset(charset)
+    , m_modificationCount(0)
     , m_loadCompleted(false)
     , m_strictParsing(!ownerRule || ownerRule->useStrictParsing())
     , m_hasSyntacticallyValidCSSHeader(true)
@@ -189,6 +192,7 @@ void CSSStyleSheet::checkLoaded()
 {
     if (isLoading())
         return;
+    ++m_modificationCount;
     if (parent())
         parent()->checkLoaded();
 
@@ -203,14 +207,13 @@ void CSSStyleSheet::styleSheetChanged()
     StyleBase* root = this;
     while (StyleBase* parent = root->parent())
         root = parent;
-    Document* documentToUpdate = root->isCSSStyleSheet() ? static_cast<CSSStyleSheet*>(root)->doc() : 0;
-    
-    /* FIXME: We don't need to do everything updateStyleSelector does,
-     * basically we just need to recreate the document's selector with the
-     * already existing style sheets.
-     */
-    if (documentToUpdate)
-        documentToUpdate->updateStyleSelector();
+    if (!root->isCSSStyleSheet())
+        return;
+    CSSStyleSheet* rootSheet = static_cast<CSSStyleSheet*>(root);
+    ++rootSheet->m_modificationCount;
+
+    if (Document* documentToUpdate = rootSheet->doc())
+        documentToUpdate->updateStyleSelector(AuthorStyleSheetsChanged);
 }
 
 KURL CSSStyleSheet::completeURL(const String& url) const
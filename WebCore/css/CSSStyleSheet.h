@@ -91,6 +91,10 @@ public:
 
     bool loadCompleted() const { return m_loadCompleted; }
 
+    // Bumped on the top-level sheet whenever its rules, or those of a sheet it imports,
+    // may have changed, so that a style selector can tell which sheets to collect again.
+    unsigned modificationCount() const { return m_modificationCount; }
+
     virtual KURL completeURL(const String& url) const;
     virtual void addSubresourceStyleURLs(ListHashSet<KURL>&);
 
@@ -113,6 +117,7 @@ private:
     Document* m_doc;
     CSSNamespace* m_namespaces;
     String m_charset;
+    unsigned m_modificationCount;
     bool m_loadCompleted : 1;
     bool m_strictParsing : 1;
     bool m_isUserStyleSheet : 1;
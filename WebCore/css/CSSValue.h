@@ -47,6 +47,10 @@ public:
 
     virtual ~CSSValue() { }
 
+    // Shared values are used by many style declarations at once, so they must
+    // not be modified in place.
+    bool isShared() const { return m_isShared; }
+
     // FIXME: Change this to return UnitTypes.
     virtual unsigned short cssValueType() const { return CSS_CUSTOM; }
 
@@ -71,6 +75,17 @@ public:
     virtual CSSParserValue parserValue() const { ASSERT_NOT_REACHED(); return CSSParserValue(); }
 
     virtual void addSubresourceStyleURLs(ListHashSet<KURL>&, const CSSStyleSheet*) { }
+
+protected:
+    CSSValue()
+        : m_isShared(false)
+    {
+    }
+
+    void setShared() { m_isShared = true; }
+
+private:
+    bool m_isShared;
 };
 
 } // namespace WebCore
@@ -169,7 +169,7 @@ void CSSVariablesDeclaration::setNeedsStyleRecalc()
     while (StyleBase* parent = root->parent())
         root = parent;
     if (root->isCSSStyleSheet())
-        static_cast<CSSStyleSheet*>(root)->doc()->updateStyleSelector();
+        static_cast<CSSStyleSheet*>(root)->styleSheetChanged();
 }
 
 }
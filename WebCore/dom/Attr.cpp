@@ -133,8 +133,10 @@ void Attr::setValue(const AtomicString& value, ExceptionCode&)
 
     setValue(value);
 
-    if (m_element)
+    if (m_element) {
+        document()->incDOMTreeVersion();
         m_element->attributeChanged(m_attribute.get());
+    }
 }
 
 void Attr::setNodeValue(const String& v, ExceptionCode& ec)
@@ -41,6 +41,10 @@
 #include "loader.h"
 #include <wtf/CurrentTime.h>
 
+#ifdef ANDROID_INSTRUMENT
+#include "StyleRecalcStatistics.h"
+#endif
+
 namespace WebCore {
 
 static void dispatchChildInsertionEvents(Node*);
@@ -785,6 +789,9 @@ void ContainerNode::setFocus(bool received)
 
     Node::setFocus(received);
 
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::PseudoStateChange);
+#endif
     // note that we need to recalc the style
     setNeedsStyleRecalc();
 }
@@ -795,6 +802,9 @@ void ContainerNode::setActive(bool down, bool pause)
 
     Node::setActive(down);
 
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::PseudoStateChange);
+#endif
     // note that we need to recalc the style
     // FIXME: Move to Element
     if (renderer()) {
@@ -838,6 +848,9 @@ void ContainerNode::setHovered(bool over)
 
     Node::setHovered(over);
 
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::PseudoStateChange);
+#endif
     // note that we need to recalc the style
     // FIXME: Move to Element
     if (renderer()) {
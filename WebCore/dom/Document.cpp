@@ -115,6 +115,7 @@
 #include "SecurityOrigin.h"
 #include "SegmentedString.h"
 #include "SelectionController.h"
+#include "SelectorQueryCache.h"
 #include "Settings.h"
 #include "StringBuffer.h"
 #include "StyleSheetList.h"
@@ -186,6 +187,7 @@
 #endif
 
 #ifdef ANDROID_INSTRUMENT
+#include "StyleRecalcStatistics.h"
 #include "TimeCounter.h"
 #endif
 
@@ -910,6 +912,13 @@ PassRefPtr<Element> Document::createElementNS(const String& namespaceURI, const
     return createElement(qName, false);
 }
 
+SelectorQueryCache* Document::selectorQueryCache()
+{
+    if (!m_selectorQueryCache)
+        m_selectorQueryCache = SelectorQueryCache::create(this);
+    return m_selectorQueryCache.get();
+}
+
 Element* Document::getElementById(const AtomicString& elementId) const
 {
     if (elementId.isEmpty())
@@ -1371,6 +1380,7 @@ void Document::recalcStyle(StyleChange change)
     
 #ifdef ANDROID_INSTRUMENT
     android::TimeCounter::start(android::TimeCounter::CalculateStyleTimeCounter);
+    StyleRecalcStatistics::willRecalcStyle(change == Force);
 #endif
     
     ASSERT(!renderer() || renderArena());
@@ -2347,7 +2357,7 @@ void Document::processHttpEquiv(const String& equiv, const String& content)
         // -dwh
         m_selectedStylesheetSet = content;
         m_preferredStylesheetSet = content;
-        updateStyleSelector();
+        updateStyleSelector(AuthorStyleSheetsChanged);
     } else if (equalIgnoringCase(equiv, "refresh")) {
         double delay;
         String url;
@@ -2532,7 +2542,7 @@ String Document::selectedStylesheetSet() const
 void Document::setSelectedStylesheetSet(const String& aString)
 {
     m_selectedStylesheetSet = aString;
-    updateStyleSelector();
+    updateStyleSelector(AuthorStyleSheetsChanged);
     if (renderer())
         renderer()->repaint();
 }
@@ -2550,7 +2560,7 @@ void Document::removePendingSheet()
         printf("Stylesheet loaded at time %d. %d stylesheets still remain.\n", elapsedTime(), m_pendingStylesheets);
 #endif
 
-    updateStyleSelector();
+    updateStyleSelector(AuthorStyleSheetsChanged);
     
     if (!m_pendingStylesheets && m_tokenizer)
         m_tokenizer->executeScriptsWaitingForStylesheets();
@@ -2559,7 +2569,7 @@ void Document::removePendingSheet()
         view()->scrollToFragment(m_frame->loader()->url());
 }
 
-void Document::updateStyleSelector()
+void Document::updateStyleSelector(StyleSelectorUpdateType updateType)
 {
     // Don't bother updating, since we haven't loaded all our style info yet
     // and haven't calculated the style selector for the first time.
@@ -2570,14 +2580,21 @@ void Document::updateStyleSelector()
         m_pendingSheetLayout = IgnoreLayoutWithPendingSheets;
         if (renderer())
             renderer()->repaint();
+        // Elements laid out with placeholder styles all need their real style.
+        updateType = FullStyleSelectorUpdate;
     }
+    if (m_hasNodesWithPlaceholderStyle)
+        updateType = FullStyleSelectorUpdate;
 
 #ifdef INSTRUMENT_LAYOUT_SCHEDULING
     if (!ownerElement())
         printf("Beginning update of style selector at time %d.\n", elapsedTime());
 #endif
 
-    recalcStyleSelector();
+    if (!recalcStyleSelector(updateType)) {
+        recalcStyle();
+        return;
+    }
     recalcStyle(Force);
 
 #ifdef INSTRUMENT_LAYOUT_SCHEDULING
@@ -2627,10 +2644,10 @@ void Document::removeStyleSheetCandidateNode(Node* node)
     m_styleSheetCandidateNodes.remove(node);
 }
 
-void Document::recalcStyleSelector()
+bool Document::recalcStyleSelector(StyleSelectorUpdateType updateType)
 {
     if (!renderer() || !attached())
-        return;
+        return true;
 
     StyleSheetVector sheets;
 
@@ -2657,7 +2674,7 @@ void Document::recalcStyleSelector()
                 // Don't apply XSL transforms until loading is finished.
                 if (!parsing())
                     applyXSLTransform(pi);
-                return;
+                return true;
             }
 #endif
             if (!sheet && !pi->localHref().isEmpty()) {
@@ -2747,8 +2764,13 @@ void Document::recalcStyleSelector()
 
     m_styleSheets->swap(sheets);
 
+    if (updateType == AuthorStyleSheetsChanged && m_styleSelector && m_didCalculateStyleSelector
+        && m_styleSelector->updateAuthorStyleSheets(m_mappedElementSheet.get(), m_styleSheets.get()))
+        return false;
+
     m_styleSelector.clear();
     m_didCalculateStyleSelector = true;
+    return true;
 }
 
 void Document::setHoverNode(PassRefPtr<Node> newHoverNode)
@@ -2949,6 +2971,9 @@ void Document::getFocusableNodes(Vector<RefPtr<Node> >& nodes)
   
 void Document::setCSSTarget(Element* n)
 {
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::PseudoStateChange);
+#endif
     if (m_cssTarget)
         m_cssTarget->setNeedsStyleRecalc();
     m_cssTarget = n;
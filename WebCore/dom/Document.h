@@ -99,6 +99,7 @@ namespace WebCore {
     class RenderView;
     class ScriptElementData;
     class SecurityOrigin;
+    class SelectorQueryCache;
     class SerializedScriptValue;
     class SegmentedString;
     class Settings;
@@ -180,6 +181,10 @@ struct FormElementKeyHashTraits : WTF::GenericHashTraits<FormElementKey> {
     static bool isDeletedValue(const FormElementKey& value) { return value.isHashTableDeletedValue(); }
 };
 
+// AuthorStyleSheetsChanged lets the style selector keep the rules of author sheets that
+// did not change and restyle only the elements the changed rules can apply to.
+enum StyleSelectorUpdateType { FullStyleSelectorUpdate, AuthorStyleSheetsChanged };
+
 class Document : public ContainerNode, public ScriptExecutionContext {
 public:
     static PassRefPtr<Document> create(Frame* frame)
@@ -424,9 +429,11 @@ public:
      * constructed from these which is used to create the a new style selector which collates all of the stylesheets
      * found and is used to calculate the derived styles for all rendering objects.
      */
-    void updateStyleSelector();
+    void updateStyleSelector(StyleSelectorUpdateType = FullStyleSelectorUpdate);
 
-    void recalcStyleSelector();
+    // Returns false if the existing style selector was updated in place and has already
+    // marked the elements that need their style recalculated.
+    bool recalcStyleSelector(StyleSelectorUpdateType = FullStyleSelectorUpdate);
 
     bool usesDescendantRules() const { return m_usesDescendantRules; }
     void setUsesDescendantRules(bool b) { m_usesDescendantRules = b; }
@@ -811,6 +818,8 @@ public:
     void incDOMTreeVersion() { ++m_domtree_version; }
     unsigned domTreeVersion() const { return m_domtree_version; }
 
+    SelectorQueryCache* selectorQueryCache();
+
     void setDocType(PassRefPtr<DocumentType>);
 
 #if ENABLE(XPATH)
@@ -1062,6 +1071,7 @@ private:
     mutable RefPtr<Element> m_documentElement;
 
     unsigned m_domtree_version;
+    OwnPtr<SelectorQueryCache> m_selectorQueryCache;
     
     HashSet<NodeIterator*> m_nodeIterators;
     HashSet<Range*> m_ranges;
@@ -56,6 +56,10 @@
 #include "SVGNames.h"
 #endif
 
+#ifdef ANDROID_INSTRUMENT
+#include "StyleRecalcStatistics.h"
+#endif
+
 namespace WebCore {
 
 using namespace HTMLNames;
@@ -611,6 +615,9 @@ void Element::updateAfterAttributeChanged(Attribute* attr)
     
 void Element::recalcStyleIfNeededAfterAttributeChanged(Attribute* attr)
 {
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::AttributeChange);
+#endif
     if (document()->attached() && document()->styleSelector()->hasSelectorForAttribute(attr->name().localName()))
         setNeedsStyleRecalc();
 }
@@ -786,7 +793,12 @@ void Element::attach()
     RenderWidget::suspendWidgetHierarchyUpdates();
 
     createRendererIfNeeded();
+    bool pushedParent = firstChild();
+    if (pushedParent)
+        document()->styleSelector()->pushParent(this);
     ContainerNode::attach();
+    if (pushedParent)
+        document()->styleSelector()->popParent(this);
     if (hasRareData()) {   
         ElementRareData* data = rareData();
         if (data->needsFocusAppearanceUpdateSoonAfterAttach()) {
@@ -859,6 +871,9 @@ void Element::recalcStyle(StyleChange change)
     }
     if (hasParentStyle && (change >= Inherit || needsStyleRecalc())) {
         RefPtr<RenderStyle> newStyle = document()->styleSelector()->styleForElement(this);
+#ifdef ANDROID_INSTRUMENT
+        StyleRecalcStatistics::didRecalcElementStyle();
+#endif
         StyleChange ch = diff(currentStyle.get(), newStyle.get());
         if (ch == Detach || !currentStyle) {
             if (attached())
@@ -921,6 +936,9 @@ void Element::recalcStyle(StyleChange change)
     // For now we will just worry about the common case, since it's a lot trickier to get the second case right
     // without doing way too much re-resolution.
     bool forceCheckOfNextElementSibling = false;
+    bool pushedParent = firstChild();
+    if (pushedParent)
+        document()->styleSelector()->pushParent(this);
     for (Node *n = firstChild(); n; n = n->nextSibling()) {
         bool childRulesChanged = n->needsStyleRecalc() && n->styleChangeType() == FullStyleChange;
         if (forceCheckOfNextElementSibling && n->isElementNode())
@@ -930,6 +948,8 @@ void Element::recalcStyle(StyleChange change)
         if (n->isElementNode())
             forceCheckOfNextElementSibling = childRulesChanged && hasDirectAdjacentRules;
     }
+    if (pushedParent)
+        document()->styleSelector()->popParent(this);
 
     setNeedsStyleRecalc(NoStyleChange);
     setChildNeedsStyleRecalc(false);
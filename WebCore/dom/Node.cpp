@@ -107,6 +107,10 @@
 #include "ChromeClient.h"
 #endif
 
+#ifdef ANDROID_INSTRUMENT
+#include "StyleRecalcStatistics.h"
+#endif
+
 #define DUMP_NODE_STATISTICS 0
 
 using namespace std;
@@ -781,6 +785,11 @@ void Node::setNeedsStyleRecalc(StyleChangeType changeType)
     if ((changeType != NoStyleChange) && !attached()) // changed compared to what?
         return;
 
+#ifdef ANDROID_INSTRUMENT
+    if (changeType != NoStyleChange && m_styleChange == NoStyleChange)
+        StyleRecalcStatistics::didInvalidate(this, changeType);
+#endif
+
     if (!(changeType == InlineStyleChange && (m_styleChange == FullStyleChange || m_styleChange == SyntheticStyleChange)))
         m_styleChange = changeType;
 
@@ -1662,28 +1671,8 @@ PassRefPtr<Element> Node::querySelector(const String& selectors, ExceptionCode&
         return 0;
     }
 
-    CSSStyleSelector::SelectorChecker selectorChecker(document(), strictParsing);
-
     // FIXME: we could also optimize for the the [id="foo"] case
-    if (strictParsing && inDocument() && querySelectorList.hasOneSelector() && querySelectorList.first()->m_match == CSSSelector::Id) {
-        Element* element = document()->getElementById(querySelectorList.first()->m_value);
-        if (element && (isDocumentNode() || element->isDescendantOf(this)) && selectorChecker.checkSelector(querySelectorList.first(), element))
-            return element;
-        return 0;
-    }
-
-    // FIXME: We can speed this up by implementing caching similar to the one use by getElementById
-    for (Node* n = firstChild(); n; n = n->traverseNextNode(this)) {
-        if (n->isElementNode()) {
-            Element* element = static_cast<Element*>(n);
-            for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
-                if (selectorChecker.checkSelector(selector, element))
-                    return element;
-            }
-        }
-    }
-    
-    return 0;
+    return firstSelectorMatch(this, selectors, querySelectorList);
 }
 
 PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCode& ec)
@@ -1692,6 +1681,11 @@ PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCo
         ec = SYNTAX_ERR;
         return 0;
     }
+
+    // Only selectors that parsed successfully are ever cached.
+    if (RefPtr<StaticNodeList> cachedList = cachedSelectorNodeList(this, selectors))
+        return cachedList.release();
+
     bool strictParsing = !document()->inCompatMode();
     CSSParser p(strictParsing);
 
@@ -1709,7 +1703,7 @@ PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCo
         return 0;
     }
 
-    return createSelectorNodeList(this, querySelectorList);
+    return createSelectorNodeList(this, selectors, querySelectorList);
 }
 
 Document *Node::ownerDocument() const
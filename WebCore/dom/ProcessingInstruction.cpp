@@ -276,7 +276,7 @@ void ProcessingInstruction::removedFromDocument()
 
     // FIXME: It's terrible to do a synchronous update of the style selector just because a <style> or <link> element got removed.
     if (m_cachedSheet)
-        document()->updateStyleSelector();
+        document()->updateStyleSelector(AuthorStyleSheetsChanged);
 }
 
 void ProcessingInstruction::finishParsingChildren()
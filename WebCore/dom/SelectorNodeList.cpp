@@ -35,39 +35,179 @@
 #include "Document.h"
 #include "Element.h"
 #include "HTMLNames.h"
+#include "SelectorQueryCache.h"
 
 namespace WebCore {
 
 using namespace HTMLNames;
 
-PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList& querySelectorList)
+// Above this many candidates an index list is only used when the query covers
+// the whole document; walking a narrower subtree is likely cheaper.
+static const size_t maximumIndexCandidatesForSubtree = 64;
+
+// Results can be cached across calls as long as the tree does not change, which
+// only holds for selectors that look at nothing but tag names, ids and classes.
+static bool selectorListIsCacheable(const CSSSelectorList& selectorList)
+{
+    for (CSSSelector* selector = selectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
+        for (CSSSelector* component = selector; component; component = component->tagHistory()) {
+            if (component->m_match != CSSSelector::None && component->m_match != CSSSelector::Id && component->m_match != CSSSelector::Class)
+                return false;
+        }
+    }
+    return true;
+}
+
+// When the selector requires an ancestor with a unique id, only that element's
+// subtree has to be searched. Returns 0 if nothing under rootNode can match.
+static Node* narrowRootForSelector(Node* rootNode, CSSSelector* selector, Document* document)
+{
+    // The combinator to the right of the compound selector being looked at;
+    // SubSelector while still inside the rightmost compound selector.
+    CSSSelector::Relation combinator = CSSSelector::SubSelector;
+    CSSSelector::Relation relation = selector->relation();
+    for (CSSSelector* component = selector->tagHistory(); component; component = component->tagHistory()) {
+        if (relation != CSSSelector::SubSelector)
+            combinator = relation;
+        if ((combinator == CSSSelector::Descendant || combinator == CSSSelector::Child)
+            && component->m_match == CSSSelector::Id && !document->containsMultipleElementsWithId(component->m_value)) {
+            Element* element = document->getElementById(component->m_value);
+            if (!element)
+                return 0;
+            if (rootNode->isDocumentNode() || element->isDescendantOf(rootNode))
+                return element;
+            if (rootNode == element || rootNode->isDescendantOf(element))
+                return rootNode;
+            return 0;
+        }
+        relation = component->relation();
+    }
+    return rootNode;
+}
+
+static bool matchesAnySelector(const CSSStyleSelector::SelectorChecker& selectorChecker, const CSSSelectorList& selectorList, Element* element)
+{
+    for (CSSSelector* selector = selectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
+        if (selectorChecker.checkSelector(selector, element))
+            return true;
+    }
+    return false;
+}
+
+static void collectSelectorMatches(Node* rootNode, const CSSSelectorList& selectorList, Vector<Element*>& matches, bool onlyFirst)
 {
-    Vector<RefPtr<Node> > nodes;
     Document* document = rootNode->document();
-    CSSSelector* onlySelector = querySelectorList.hasOneSelector() ? querySelectorList.first() : 0;
+    CSSSelector* onlySelector = selectorList.hasOneSelector() ? selectorList.first() : 0;
     bool strictParsing = !document->inCompatMode();
 
     CSSStyleSelector::SelectorChecker selectorChecker(document, strictParsing);
 
-    if (strictParsing && rootNode->inDocument() && onlySelector && onlySelector->m_match == CSSSelector::Id && !document->containsMultipleElementsWithId(onlySelector->m_value)) {
-        Element* element = document->getElementById(onlySelector->m_value);
-        if (element && (rootNode->isDocumentNode() || element->isDescendantOf(rootNode)) && selectorChecker.checkSelector(onlySelector, element))
-            nodes.append(element);
-    } else {
-        for (Node* n = rootNode->firstChild(); n; n = n->traverseNextNode(rootNode)) {
-            if (n->isElementNode()) {
-                Element* element = static_cast<Element*>(n);
-                for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
-                    if (selectorChecker.checkSelector(selector, element)) {
-                        nodes.append(n);
-                        break;
-                    }
+    Node* searchRoot = rootNode;
+    if (onlySelector && strictParsing && rootNode->inDocument()) {
+        // Look at the rightmost compound selector for an id, a class or a tag name
+        // to take candidates from.
+        CSSSelector* idSelector = 0;
+        CSSSelector* classSelector = 0;
+        AtomicStringImpl* localName = 0;
+        for (CSSSelector* component = onlySelector; component; component = component->relation() == CSSSelector::SubSelector ? component->tagHistory() : 0) {
+            if (component->m_match == CSSSelector::Id && !idSelector)
+                idSelector = component;
+            else if (component->m_match == CSSSelector::Class && !classSelector)
+                classSelector = component;
+            if (component->m_tag.localName() != starAtom)
+                localName = component->m_tag.localName().impl();
+        }
+
+        if (idSelector && !document->containsMultipleElementsWithId(idSelector->m_value)) {
+            Element* element = document->getElementById(idSelector->m_value);
+            if (element && (rootNode->isDocumentNode() || element->isDescendantOf(rootNode)) && selectorChecker.checkSelector(onlySelector, element))
+                matches.append(element);
+            return;
+        }
+
+        searchRoot = narrowRootForSelector(rootNode, onlySelector, document);
+        if (!searchRoot)
+            return;
+
+        SelectorQueryCache* cache = document->selectorQueryCache();
+        const Vector<Element*>* candidates = 0;
+        if (classSelector)
+            candidates = cache->elementsWithClassName(classSelector->m_value.impl());
+        else if (localName)
+            candidates = cache->elementsWithLocalName(localName);
+        if (candidates && (searchRoot->isDocumentNode() || candidates->size() <= maximumIndexCandidatesForSubtree)) {
+            size_t count = candidates->size();
+            for (size_t i = 0; i < count; ++i) {
+                Element* element = candidates->at(i);
+                if ((searchRoot->isDocumentNode() || element->isDescendantOf(searchRoot)) && selectorChecker.checkSelector(onlySelector, element)) {
+                    matches.append(element);
+                    if (onlyFirst)
+                        return;
                 }
             }
+            return;
         }
     }
-    
+
+    for (Node* n = searchRoot->firstChild(); n; n = n->traverseNextNode(searchRoot)) {
+        if (n->isElementNode()) {
+            Element* element = static_cast<Element*>(n);
+            if (matchesAnySelector(selectorChecker, selectorList, element)) {
+                matches.append(element);
+                if (onlyFirst)
+                    return;
+            }
+        }
+    }
+}
+
+static PassRefPtr<StaticNodeList> createStaticNodeList(const Vector<Element*>& elements)
+{
+    Vector<RefPtr<Node> > nodes;
+    size_t count = elements.size();
+    nodes.reserveInitialCapacity(count);
+    for (size_t i = 0; i < count; ++i)
+        nodes.uncheckedAppend(elements[i]);
     return StaticNodeList::adopt(nodes);
 }
 
+PassRefPtr<StaticNodeList> cachedSelectorNodeList(Node* rootNode, const String& selectors)
+{
+    if (!rootNode->inDocument())
+        return 0;
+
+    SelectorQueryCache* cache = rootNode->document()->selectorQueryCache();
+    cache->willQuery();
+    Vector<Element*> elements;
+    if (!cache->cachedResult(rootNode, selectors, elements))
+        return 0;
+    return createStaticNodeList(elements);
+}
+
+PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const String& selectors, const CSSSelectorList& querySelectorList)
+{
+    Vector<Element*> elements;
+    collectSelectorMatches(rootNode, querySelectorList, elements, false);
+
+    if (rootNode->inDocument() && selectorListIsCacheable(querySelectorList))
+        rootNode->document()->selectorQueryCache()->addResult(rootNode, selectors, elements);
+
+    return createStaticNodeList(elements);
+}
+
+Element* firstSelectorMatch(Node* rootNode, const String& selectors, const CSSSelectorList& querySelectorList)
+{
+    if (rootNode->inDocument()) {
+        Vector<Element*> elements;
+        SelectorQueryCache* cache = rootNode->document()->selectorQueryCache();
+        cache->willQuery();
+        if (cache->cachedResult(rootNode, selectors, elements))
+            return elements.isEmpty() ? 0 : elements[0];
+    }
+
+    Vector<Element*> elements;
+    collectSelectorMatches(rootNode, querySelectorList, elements, true);
+    return elements.isEmpty() ? 0 : elements[0];
+}
+
 } // namespace WebCore
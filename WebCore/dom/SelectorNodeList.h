@@ -34,8 +34,17 @@
 namespace WebCore {
 
     class CSSSelectorList;
+    class Element;
+    class String;
 
-    PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList&);
+    // Returns the result of an earlier query with the same selectors and root if
+    // the tree has not changed since, or 0.
+    PassRefPtr<StaticNodeList> cachedSelectorNodeList(Node* rootNode, const String& selectors);
+    PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const String& selectors, const CSSSelectorList&);
+
+    // The first element in document order under rootNode that matches one of the
+    // selectors, or 0.
+    Element* firstSelectorMatch(Node* rootNode, const String& selectors, const CSSSelectorList&);
 
 } // namespace WebCore
 
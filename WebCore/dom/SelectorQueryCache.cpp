@@ -0,0 +1,169 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "SelectorQueryCache.h"
+
+#include "Document.h"
+#include "Element.h"
+#include "StyledElement.h"
+#include <wtf/StdLibExtras.h>
+
+namespace WebCore {
+
+// Results are dropped wholesale once this many different queries are cached.
+static const unsigned maximumCachedResults = 32;
+
+// Number of queries without a tree change before the indexes are built.
+static const unsigned queriesBeforeIndexing = 2;
+
+SelectorQueryCache::SelectorQueryCache(Document* document)
+    : m_document(document)
+    , m_domTreeVersion(document->domTreeVersion())
+    , m_queriesSinceTreeChange(0)
+    , m_indexesBuilt(false)
+{
+}
+
+SelectorQueryCache::~SelectorQueryCache()
+{
+    clear();
+}
+
+void SelectorQueryCache::clear()
+{
+    deleteAllValues(m_classIndex);
+    m_classIndex.clear();
+    deleteAllValues(m_localNameIndex);
+    m_localNameIndex.clear();
+    m_indexesBuilt = false;
+
+    deleteAllValues(m_results);
+    m_results.clear();
+}
+
+void SelectorQueryCache::invalidateIfTreeChanged()
+{
+    unsigned domTreeVersion = m_document->domTreeVersion();
+    if (domTreeVersion == m_domTreeVersion)
+        return;
+
+    m_domTreeVersion = domTreeVersion;
+    m_queriesSinceTreeChange = 0;
+    clear();
+}
+
+void SelectorQueryCache::willQuery()
+{
+    invalidateIfTreeChanged();
+    ++m_queriesSinceTreeChange;
+}
+
+static inline void addToIndex(HashMap<AtomicStringImpl*, Vector<Element*>*>& index, AtomicStringImpl* key, Element* element)
+{
+    pair<HashMap<AtomicStringImpl*, Vector<Element*>*>::iterator, bool> result = index.add(key, 0);
+    if (result.second)
+        result.first->second = new Vector<Element*>;
+    Vector<Element*>& elements = *result.first->second;
+    // An element can list the same class more than once.
+    if (elements.isEmpty() || elements.last() != element)
+        elements.append(element);
+}
+
+void SelectorQueryCache::buildIndexes()
+{
+    ASSERT(!m_indexesBuilt);
+    for (Node* n = m_document->firstChild(); n; n = n->traverseNextNode()) {
+        if (!n->isElementNode())
+            continue;
+        Element* element = static_cast<Element*>(n);
+        addToIndex(m_localNameIndex, element->localName().impl(), element);
+        if (element->hasClass()) {
+            const SpaceSplitString& classNames = static_cast<StyledElement*>(element)->classNames();
+            size_t count = classNames.size();
+            for (size_t i = 0; i < count; ++i)
+                addToIndex(m_classIndex, classNames[i].impl(), element);
+        }
+    }
+    m_indexesBuilt = true;
+}
+
+static const Vector<Element*>* lookUp(const HashMap<AtomicStringImpl*, Vector<Element*>*>& index, AtomicStringImpl* key)
+{
+    DEFINE_STATIC_LOCAL(Vector<Element*>, noElements, ());
+    Vector<Element*>* elements = index.get(key);
+    return elements ? elements : &noElements;
+}
+
+bool SelectorQueryCache::ensureIndexes()
+{
+    invalidateIfTreeChanged();
+    if (m_indexesBuilt)
+        return true;
+    if (m_queriesSinceTreeChange < queriesBeforeIndexing)
+        return false;
+    buildIndexes();
+    return true;
+}
+
+const Vector<Element*>* SelectorQueryCache::elementsWithClassName(AtomicStringImpl* className)
+{
+    return ensureIndexes() ? lookUp(m_classIndex, className) : 0;
+}
+
+const Vector<Element*>* SelectorQueryCache::elementsWithLocalName(AtomicStringImpl* localName)
+{
+    return ensureIndexes() ? lookUp(m_localNameIndex, localName) : 0;
+}
+
+bool SelectorQueryCache::cachedResult(Node* root, const String& selectors, Vector<Element*>& result)
+{
+    invalidateIfTreeChanged();
+    ResultMap::iterator it = m_results.find(selectors);
+    if (it == m_results.end() || it->second->root != root)
+        return false;
+    result = it->second->elements;
+    return true;
+}
+
+void SelectorQueryCache::addResult(Node* root, const String& selectors, const Vector<Element*>& result)
+{
+    invalidateIfTreeChanged();
+    if (m_results.size() >= maximumCachedResults) {
+        deleteAllValues(m_results);
+        m_results.clear();
+    }
+
+    CachedResult* entry = new CachedResult;
+    entry->root = root;
+    entry->elements = result;
+    pair<ResultMap::iterator, bool> added = m_results.add(selectors, entry);
+    if (!added.second) {
+        delete added.first->second;
+        added.first->second = entry;
+    }
+}
+
+} // namespace WebCore
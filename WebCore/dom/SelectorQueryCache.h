@@ -0,0 +1,92 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SelectorQueryCache_h
+#define SelectorQueryCache_h
+
+#include "PlatformString.h"
+#include "StringHash.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PassOwnPtr.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class AtomicStringImpl;
+class Document;
+class Element;
+class Node;
+
+// Per-document state that speeds up querySelector() and querySelectorAll()
+// for roots in the document. It holds tag name and class indexes of the
+// document's elements in document order, and the results of recent queries.
+// Everything is dropped as soon as the document's DOM tree version changes.
+class SelectorQueryCache : public Noncopyable {
+public:
+    static PassOwnPtr<SelectorQueryCache> create(Document* document) { return new SelectorQueryCache(document); }
+    ~SelectorQueryCache();
+
+    // Called once per query. The indexes are only built once a second query
+    // arrives without the tree changing in between, so that pages which
+    // mutate the DOM between every query don't pay for them.
+    void willQuery();
+
+    // The elements of the document with the given class or local name in document
+    // order, or 0 if the indexes are not available yet.
+    const Vector<Element*>* elementsWithClassName(AtomicStringImpl*);
+    const Vector<Element*>* elementsWithLocalName(AtomicStringImpl*);
+
+    bool cachedResult(Node* root, const String& selectors, Vector<Element*>& result);
+    void addResult(Node* root, const String& selectors, const Vector<Element*>& result);
+
+private:
+    SelectorQueryCache(Document*);
+
+    void invalidateIfTreeChanged();
+    bool ensureIndexes();
+    void buildIndexes();
+    void clear();
+
+    typedef HashMap<AtomicStringImpl*, Vector<Element*>*> ElementIndex;
+
+    struct CachedResult {
+        Node* root;
+        Vector<Element*> elements;
+    };
+    typedef HashMap<String, CachedResult*> ResultMap;
+
+    Document* m_document;
+    unsigned m_domTreeVersion;
+    unsigned m_queriesSinceTreeChange;
+    bool m_indexesBuilt;
+    ElementIndex m_classIndex;
+    ElementIndex m_localNameIndex;
+    ResultMap m_results;
+};
+
+} // namespace WebCore
+
+#endif // SelectorQueryCache_h
@@ -53,7 +53,7 @@ void StyleElement::removedFromDocument(Document* document)
 
     // FIXME: It's terrible to do a synchronous update of the style selector just because a <style> or <link> element got removed.
     if (m_sheet)
-        document->updateStyleSelector();
+        document->updateStyleSelector(AuthorStyleSheetsChanged);
 }
 
 void StyleElement::process(Element* e)
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "WebCore"
+
+#include "config.h"
+#include "StyleRecalcStatistics.h"
+
+#ifdef ANDROID_INSTRUMENT
+
+#include "CString.h"
+#include "Element.h"
+#include "HTMLNames.h"
+#include <utils/Log.h>
+
+namespace WebCore {
+
+StyleRecalcStatistics::Reason StyleRecalcStatistics::s_currentReason = StyleRecalcStatistics::OtherChange;
+bool StyleRecalcStatistics::s_tracing = false;
+unsigned StyleRecalcStatistics::s_invalidations[ReasonCount];
+unsigned StyleRecalcStatistics::s_recalcPasses = 0;
+unsigned StyleRecalcStatistics::s_forcedRecalcPasses = 0;
+unsigned StyleRecalcStatistics::s_elementsRecalculated = 0;
+unsigned StyleRecalcStatistics::s_stylesResolved = 0;
+double StyleRecalcStatistics::s_styleResolutionTime = 0;
+
+void StyleRecalcStatistics::didInvalidate(Node* node, StyleChangeType changeType)
+{
+    Reason reason = s_currentReason;
+    if (reason == OtherChange && changeType == InlineStyleChange)
+        reason = StyleAttributeChange;
+    ++s_invalidations[reason];
+
+    if (!s_tracing)
+        return;
+    if (node->isElementNode()) {
+        Element* element = static_cast<Element*>(node);
+        LOGD("Style invalidated (%s): <%s> %p id=\"%s\" class=\"%s\"", reasonName(reason),
+            element->tagName().utf8().data(), element,
+            element->getAttribute(element->idAttributeName()).string().utf8().data(),
+            element->getAttribute(HTMLNames::classAttr).string().utf8().data());
+    } else
+        LOGD("Style invalidated (%s): %s %p", reasonName(reason), node->nodeName().utf8().data(), node);
+}
+
+void StyleRecalcStatistics::willRecalcStyle(bool forced)
+{
+    ++s_recalcPasses;
+    if (forced)
+        ++s_forcedRecalcPasses;
+    if (s_tracing)
+        LOGD("Style recalc%s", forced ? " (forced)" : "");
+}
+
+void StyleRecalcStatistics::didResolveStyle(double seconds)
+{
+    ++s_stylesResolved;
+    s_styleResolutionTime += seconds;
+}
+
+const char* StyleRecalcStatistics::reasonName(Reason reason)
+{
+    switch (reason) {
+    case OtherChange:
+        return "other";
+    case StyleAttributeChange:
+        return "style attribute";
+    case ClassChange:
+        return "class";
+    case AttributeChange:
+        return "attribute";
+    case PseudoStateChange:
+        return "pseudo state";
+    case StyleSheetChange:
+        return "style sheet";
+    case ReasonCount:
+        break;
+    }
+    ASSERT_NOT_REACHED();
+    return "";
+}
+
+String StyleRecalcStatistics::dump()
+{
+    String result = String::format("Style recalc: %u passes (%u forced), %u elements recalculated\n",
+        s_recalcPasses, s_forcedRecalcPasses, s_elementsRecalculated);
+    result += "Style invalidations:";
+    for (unsigned i = 0; i < ReasonCount; ++i)
+        result += String::format(" %s %u%s", reasonName(static_cast<Reason>(i)), s_invalidations[i], i + 1 < ReasonCount ? "," : "\n");
+    result += String::format("styleForElement: %u calls, %.1f ms\n", s_stylesResolved, s_styleResolutionTime * 1000);
+    return result;
+}
+
+void StyleRecalcStatistics::reset()
+{
+    for (unsigned i = 0; i < ReasonCount; ++i)
+        s_invalidations[i] = 0;
+    s_recalcPasses = 0;
+    s_forcedRecalcPasses = 0;
+    s_elementsRecalculated = 0;
+    s_stylesResolved = 0;
+    s_styleResolutionTime = 0;
+}
+
+} // namespace WebCore
+
+#endif // ANDROID_INSTRUMENT
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef StyleRecalcStatistics_h
+#define StyleRecalcStatistics_h
+
+#ifdef ANDROID_INSTRUMENT
+
+#include "Node.h"
+#include "PlatformString.h"
+#include <wtf/CurrentTime.h>
+#include <wtf/Noncopyable.h>
+
+namespace WebCore {
+
+class Element;
+
+// Counts why nodes are marked for a style recalc, how many elements have
+// their style recomputed and how long styleForElement() takes, so we can see
+// which CSS optimizations pay off on real pages. Optionally logs every node
+// as it is marked. Main thread only.
+class StyleRecalcStatistics {
+public:
+    enum Reason {
+        OtherChange,
+        StyleAttributeChange,
+        ClassChange,
+        AttributeChange,
+        PseudoStateChange,
+        StyleSheetChange,
+        ReasonCount
+    };
+
+    // Nodes marked while a Scope is alive are counted under its reason.
+    class Scope : public Noncopyable {
+    public:
+        Scope(Reason reason)
+            : m_previousReason(s_currentReason)
+        {
+            s_currentReason = reason;
+        }
+
+        ~Scope() { s_currentReason = m_previousReason; }
+
+    private:
+        Reason m_previousReason;
+    };
+
+    // Times a styleForElement() call.
+    class ResolutionTimer : public Noncopyable {
+    public:
+        ResolutionTimer() : m_startTime(currentTime()) { }
+        ~ResolutionTimer() { didResolveStyle(currentTime() - m_startTime); }
+
+    private:
+        double m_startTime;
+    };
+
+    // Called by Node::setNeedsStyleRecalc() when a clean node is marked.
+    static void didInvalidate(Node*, StyleChangeType);
+    // Called by Document::recalcStyle() for every recalc pass.
+    static void willRecalcStyle(bool forced);
+    // Called by Element::recalcStyle() for every element it gets a new
+    // style for.
+    static void didRecalcElementStyle() { ++s_elementsRecalculated; }
+    static void didResolveStyle(double seconds);
+
+    static unsigned invalidations(Reason reason) { return s_invalidations[reason]; }
+    static unsigned recalcPasses() { return s_recalcPasses; }
+    static unsigned forcedRecalcPasses() { return s_forcedRecalcPasses; }
+    static unsigned elementsRecalculated() { return s_elementsRecalculated; }
+    static unsigned stylesResolved() { return s_stylesResolved; }
+    static double styleResolutionTime() { return s_styleResolutionTime; }
+    static const char* reasonName(Reason);
+
+    static bool isTracing() { return s_tracing; }
+    static void setTracing(bool tracing) { s_tracing = tracing; }
+
+    // A few lines of text with all of the above, for logging.
+    static String dump();
+    static void reset();
+
+private:
+    static Reason s_currentReason;
+    static bool s_tracing;
+    static unsigned s_invalidations[ReasonCount];
+    static unsigned s_recalcPasses;
+    static unsigned s_forcedRecalcPasses;
+    static unsigned s_elementsRecalculated;
+    static unsigned s_stylesResolved;
+    static double s_styleResolutionTime;
+};
+
+} // namespace WebCore
+
+#endif // ANDROID_INSTRUMENT
+
+#endif // StyleRecalcStatistics_h
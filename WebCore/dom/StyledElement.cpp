@@ -32,6 +32,10 @@
 #include "MappedAttribute.h"
 #include <wtf/HashFunctions.h>
 
+#ifdef ANDROID_INSTRUMENT
+#include "StyleRecalcStatistics.h"
+#endif
+
 using namespace std;
 
 namespace WebCore {
@@ -145,6 +149,9 @@ void StyledElement::destroyInlineStyleDecl()
 
 void StyledElement::attributeChanged(Attribute* attr, bool preserveDecls)
 {
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::AttributeChange);
+#endif
     if (!attr->isMappedAttribute()) {
         Element::attributeChanged(attr, preserveDecls);
         return;
@@ -228,6 +235,9 @@ void StyledElement::classAttributeChanged(const AtomicString& newClassString)
         else
             mappedAttributes()->clearClass();
     }
+#ifdef ANDROID_INSTRUMENT
+    StyleRecalcStatistics::Scope statisticsScope(StyleRecalcStatistics::ClassChange);
+#endif
     setNeedsStyleRecalc();
     dispatchSubtreeModifiedEvent();
 }
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "BackgroundPreloadScanner.h"
+
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+
+#include "DocLoader.h"
+#include "Document.h"
+#include "SegmentedString.h"
+#include <wtf/MainThread.h>
+
+namespace WebCore {
+
+PassRefPtr<BackgroundPreloadScanner> BackgroundPreloadScanner::create(Document* document)
+{
+    RefPtr<BackgroundPreloadScanner> scanner = adoptRef(new BackgroundPreloadScanner(document));
+    // Balanced in threadDidExitCallback().
+    scanner->ref();
+    scanner->m_threadID = createThread(BackgroundPreloadScanner::threadEntryPointCallback, scanner.get(), "WebCore: PreloadScanner");
+    if (!scanner->m_threadID)
+        scanner->deref();
+    return scanner.release();
+}
+
+BackgroundPreloadScanner::BackgroundPreloadScanner(Document* document)
+    : m_document(document)
+    , m_threadID(0)
+    , m_ended(false)
+    , m_dispatchScheduled(false)
+{
+}
+
+BackgroundPreloadScanner::~BackgroundPreloadScanner()
+{
+    ASSERT(isMainThread());
+    ASSERT(!m_threadID);
+}
+
+void BackgroundPreloadScanner::write(const SegmentedString& source)
+{
+    ASSERT(isMainThread());
+    if (m_ended || !m_threadID)
+        return;
+
+    String chunk = source.toString();
+    if (chunk.isEmpty())
+        return;
+    m_queue.append(new Chunk(chunk.crossThreadString()));
+}
+
+void BackgroundPreloadScanner::end()
+{
+    ASSERT(isMainThread());
+    if (m_ended || !m_threadID)
+        return;
+
+    m_ended = true;
+    m_queue.append(new Chunk(String()));
+}
+
+void BackgroundPreloadScanner::detach()
+{
+    ASSERT(isMainThread());
+    m_document = 0;
+    m_ended = true;
+    if (m_threadID) {
+        // The thread stops at its next message, but may still be scanning a
+        // chunk; it only touches the queue and the request list until then.
+        m_queue.kill();
+        detachThread(m_threadID);
+        m_threadID = 0;
+    }
+
+    MutexLocker locker(m_requestsMutex);
+    m_requests.clear();
+}
+
+void* BackgroundPreloadScanner::threadEntryPointCallback(void* scanner)
+{
+    return static_cast<BackgroundPreloadScanner*>(scanner)->threadEntryPoint();
+}
+
+void* BackgroundPreloadScanner::threadEntryPoint()
+{
+    ASSERT(!isMainThread());
+    PreloadScanner scanner(0);
+    Vector<PreloadRequest> requests;
+
+    scanner.begin();
+    while (OwnPtr<Chunk> chunk = m_queue.waitForMessage()) {
+        if (chunk->source.isNull())
+            break;
+        scanner.write(SegmentedString(chunk->source));
+        scanner.takePreloadRequests(requests);
+        if (!requests.isEmpty())
+            queuePreloadRequests(requests);
+    }
+    scanner.end();
+
+    callOnMainThread(BackgroundPreloadScanner::threadDidExitCallback, this);
+    return 0;
+}
+
+void BackgroundPreloadScanner::threadDidExitCallback(void* context)
+{
+    static_cast<BackgroundPreloadScanner*>(context)->deref();
+}
+
+void BackgroundPreloadScanner::queuePreloadRequests(Vector<PreloadRequest>& requests)
+{
+    ASSERT(!isMainThread());
+    MutexLocker locker(m_requestsMutex);
+    for (size_t i = 0; i < requests.size(); ++i) {
+        PreloadRequest request;
+        request.type = requests[i].type;
+        request.url = requests[i].url.crossThreadString();
+        request.charset = requests[i].charset.crossThreadString();
+        request.inBody = requests[i].inBody;
+        m_requests.append(request);
+    }
+    requests.clear();
+
+    if (m_dispatchScheduled)
+        return;
+    m_dispatchScheduled = true;
+    // Balanced in dispatchPreloadRequestsCallback().
+    ref();
+    callOnMainThread(BackgroundPreloadScanner::dispatchPreloadRequestsCallback, this);
+}
+
+void BackgroundPreloadScanner::dispatchPreloadRequestsCallback(void* context)
+{
+    BackgroundPreloadScanner* scanner = static_cast<BackgroundPreloadScanner*>(context);
+    scanner->dispatchPreloadRequests();
+    scanner->deref();
+}
+
+void BackgroundPreloadScanner::dispatchPreloadRequests()
+{
+    ASSERT(isMainThread());
+    Vector<PreloadRequest> requests;
+    {
+        MutexLocker locker(m_requestsMutex);
+        requests.swap(m_requests);
+        m_dispatchScheduled = false;
+    }
+
+    if (!m_document)
+        return;
+
+    DocLoader* docLoader = m_document->docLoader();
+    bool bodyExists = m_document->body();
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const PreloadRequest& request = requests[i];
+        docLoader->preload(request.type, request.url, request.charset, request.inBody || bodyExists);
+    }
+}
+
+} // namespace WebCore
+
+#endif // ENABLE(BACKGROUND_PRELOAD_SCANNER)
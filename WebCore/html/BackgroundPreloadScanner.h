@@ -0,0 +1,96 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BackgroundPreloadScanner_h
+#define BackgroundPreloadScanner_h
+
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+
+#include "PlatformString.h"
+#include "PreloadScanner.h"
+#include <wtf/MessageQueue.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class Document;
+class SegmentedString;
+
+// Runs a PreloadScanner over the document source on a background thread as
+// it arrives from the network, so that subresource loads are discovered
+// without waiting for the main thread tokenizer to reach them. The resources
+// found are handed back to the main thread and preloaded from there.
+class BackgroundPreloadScanner : public ThreadSafeShared<BackgroundPreloadScanner> {
+public:
+    static PassRefPtr<BackgroundPreloadScanner> create(Document*);
+    ~BackgroundPreloadScanner();
+
+    // All of these are called on the main thread.
+    void write(const SegmentedString&);
+    // No more source will be written; the thread exits once it has scanned
+    // what it already has.
+    void end();
+    // Stops scanning and drops any preloads not issued yet. The thread is
+    // not waited for; it keeps a reference to the scanner and releases it on
+    // the main thread when it exits. Must be called before the document goes
+    // away.
+    void detach();
+
+private:
+    BackgroundPreloadScanner(Document*);
+
+    struct Chunk {
+        Chunk(const String& source) : source(source) { }
+        // A null source marks the end of the document.
+        String source;
+    };
+
+    // Called on background thread.
+    static void* threadEntryPointCallback(void*);
+    void* threadEntryPoint();
+    void queuePreloadRequests(Vector<PreloadRequest>&);
+
+    static void threadDidExitCallback(void*);
+
+    static void dispatchPreloadRequestsCallback(void*);
+    void dispatchPreloadRequests();
+
+    Document* m_document;
+    ThreadIdentifier m_threadID;
+    MessageQueue<Chunk> m_queue;
+    bool m_ended;
+
+    Mutex m_requestsMutex;
+    Vector<PreloadRequest> m_requests;
+    bool m_dispatchScheduled;
+};
+
+} // namespace WebCore
+
+#endif // ENABLE(BACKGROUND_PRELOAD_SCANNER)
+
+#endif // BackgroundPreloadScanner_h
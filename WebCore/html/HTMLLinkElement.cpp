@@ -108,7 +108,7 @@ void HTMLLinkElement::setDisabledState(bool _disabled)
         if (!m_sheet && m_disabledState == 1)
             process();
         else
-            document()->updateStyleSelector(); // Update the style selector.
+            document()->updateStyleSelector(AuthorStyleSheetsChanged); // Update the style selector.
     }
 }
 
@@ -147,9 +147,9 @@ void HTMLLinkElement::parseMappedAttribute(MappedAttribute *attr)
 }
 
 #ifdef ANDROID_APPLE_TOUCH_ICON
-void HTMLLinkElement::tokenizeRelAttribute(const AtomicString& rel, bool& styleSheet, bool& alternate, bool& icon, bool& touchIcon, bool& precomposedTouchIcon, bool& dnsPrefetch)
+void HTMLLinkElement::tokenizeRelAttribute(const String& rel, bool& styleSheet, bool& alternate, bool& icon, bool& touchIcon, bool& precomposedTouchIcon, bool& dnsPrefetch)
 #else
-void HTMLLinkElement::tokenizeRelAttribute(const AtomicString& rel, bool& styleSheet, bool& alternate, bool& icon, bool& dnsPrefetch)
+void HTMLLinkElement::tokenizeRelAttribute(const String& rel, bool& styleSheet, bool& alternate, bool& icon, bool& dnsPrefetch)
 #endif
 {
     styleSheet = false;
@@ -177,7 +177,7 @@ void HTMLLinkElement::tokenizeRelAttribute(const AtomicString& rel, bool& styleS
         alternate = true;
     } else {
         // Tokenize the rel attribute and set bits based on specific keywords that we find.
-        String relString = rel.string();
+        String relString = rel;
         relString.replace('\n', ' ');
         Vector<String> list;
         relString.split(' ', list);
@@ -257,7 +257,7 @@ void HTMLLinkElement::process()
     } else if (m_sheet) {
         // we no longer contain a stylesheet, e.g. perhaps rel or type was changed
         m_sheet = 0;
-        document()->updateStyleSelector();
+        document()->updateStyleSelector(AuthorStyleSheetsChanged);
     }
 }
 
@@ -276,7 +276,7 @@ void HTMLLinkElement::removedFromDocument()
 
     // FIXME: It's terrible to do a synchronous update of the style selector just because a <style> or <link> element got removed.
     if (document()->renderer())
-        document()->updateStyleSelector();
+        document()->updateStyleSelector(AuthorStyleSheetsChanged);
 }
 
 void HTMLLinkElement::finishParsingChildren()
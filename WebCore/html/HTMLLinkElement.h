@@ -94,9 +94,9 @@ public:
     virtual bool isURLAttribute(Attribute*) const;
     
 #ifdef ANDROID_APPLE_TOUCH_ICON
-    static void tokenizeRelAttribute(const AtomicString& value, bool& stylesheet, bool& alternate, bool& icon, bool& touchIcon, bool& precomposedTouchIcon, bool& dnsPrefetch);
+    static void tokenizeRelAttribute(const String& value, bool& stylesheet, bool& alternate, bool& icon, bool& touchIcon, bool& precomposedTouchIcon, bool& dnsPrefetch);
 #else
-    static void tokenizeRelAttribute(const AtomicString& value, bool& stylesheet, bool& alternate, bool& icon, bool& dnsPrefetch);
+    static void tokenizeRelAttribute(const String& value, bool& stylesheet, bool& alternate, bool& icon, bool& dnsPrefetch);
 #endif
 
     virtual void addSubresourceAttributeURLs(ListHashSet<KURL>&) const;
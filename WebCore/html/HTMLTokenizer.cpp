@@ -28,6 +28,8 @@
 #include "config.h"
 #include "HTMLTokenizer.h"
 
+#include "ASCIIFastPath.h"
+#include "BackgroundPreloadScanner.h"
 #include "CSSHelper.h"
 #include "Cache.h"
 #include "CachedScript.h"
@@ -559,7 +561,12 @@ HTMLTokenizer::State HTMLTokenizer::scriptHandler(State state)
     }
     
 #if PRELOAD_SCANNER_ENABLED
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    // The background scanner has already seen everything that came in from the network.
+    if (!m_pendingScripts.isEmpty() && !m_executingScript && !m_backgroundPreloadScanner) {
+#else
     if (!m_pendingScripts.isEmpty() && !m_executingScript) {
+#endif
         if (!m_preloadScanner)
             m_preloadScanner.set(new PreloadScanner(m_doc));
         if (!m_preloadScanner->inProgress()) {
@@ -744,8 +751,21 @@ HTMLTokenizer::State HTMLTokenizer::parseText(SegmentedString& src, State state)
         if (cc == '\r') {
             state.setSkipLF(true);
             *m_dest++ = '\n';
-        } else
+        } else {
+            if (cc != '\n') {
+                int runLength;
+                const UChar* run = src.currentRun(runLength);
+                int length = runLength > 1 ? 1 + findFirstOf(run + 1, runLength - 1, '\r', '\n', '\r', '\n') : 1;
+                if (length > 1) {
+                    checkBuffer(length);
+                    memcpy(m_dest, run, length * sizeof(UChar));
+                    m_dest += length;
+                    src.advancePastNonNewlines(length);
+                    continue;
+                }
+            }
             *m_dest++ = cc;
+        }
         src.advance(m_lineNumber);
     }
 
@@ -1444,6 +1464,18 @@ HTMLTokenizer::State HTMLTokenizer::parseTag(SegmentedString& src, State state)
                         src.advancePastNonNewline();
                         break;
                     }
+                } else {
+                    // Everything above '>' is copied as is, so take the whole run at once.
+                    int runLength;
+                    const UChar* run = src.currentRun(runLength);
+                    int length = runLength > 1 ? 1 + findFirstAtOrBelow(run + 1, runLength - 1, '>') : 1;
+                    if (length > 1) {
+                        checkBuffer(length);
+                        memcpy(m_dest, run, length * sizeof(UChar));
+                        m_dest += length;
+                        src.advancePastNonNewlines(length);
+                        continue;
+                    }
                 }
 
                 *m_dest++ = curchar;
@@ -1649,6 +1681,16 @@ void HTMLTokenizer::write(const SegmentedString& str, bool appendData)
     if (m_parserStopped)
         return;
 
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    // Hand data arriving from the network to the background scanner before it gets
+    // queued behind any blocking scripts, so its subresources start loading early.
+    if (appendData && !str.isEmpty() && !m_fragment && !inViewSourceMode()) {
+        if (!m_backgroundPreloadScanner)
+            m_backgroundPreloadScanner = BackgroundPreloadScanner::create(m_doc);
+        m_backgroundPreloadScanner->write(str);
+    }
+#endif
+
     SegmentedString source(str);
     if (m_executingScript)
         source.setExcludeLineNumbers();
@@ -1811,8 +1853,22 @@ void HTMLTokenizer::write(const SegmentedString& str, bool appendData)
             m_src.advance(m_lineNumber);
         } else {
             state.setDiscardLF(false);
-            *m_dest++ = cc;
-            m_src.advancePastNonNewline();
+            // Copy the whole run of characters that need no handling at once instead of
+            // going around the loop for each of them. Escaped characters are never part
+            // of a run, since they are read from the pushed characters.
+            int runLength;
+            const UChar* run = m_src.currentRun(runLength);
+            int length = runLength > 1 ? 1 + findFirstOf(run + 1, runLength - 1, '<', '&', '\n', '\r') : 1;
+            if (length > 1) {
+                checkBuffer(length);
+                memcpy(m_dest, run, length * sizeof(UChar));
+                m_dest += length;
+                m_src.advancePastNonNewlines(length);
+                processedCount += length - 1;
+            } else {
+                *m_dest++ = cc;
+                m_src.advancePastNonNewline();
+            }
         }
     }
     
@@ -1845,6 +1901,12 @@ void HTMLTokenizer::stopParsing()
 {
     Tokenizer::stopParsing();
     m_timer.stop();
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    if (m_backgroundPreloadScanner) {
+        m_backgroundPreloadScanner->detach();
+        m_backgroundPreloadScanner = 0;
+    }
+#endif
 
     // The part needs to know that the tokenizer has finished with its data,
     // regardless of whether it happened naturally or due to manual intervention.
@@ -1901,6 +1963,11 @@ void HTMLTokenizer::end()
 
 void HTMLTokenizer::finish()
 {
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    if (m_backgroundPreloadScanner)
+        m_backgroundPreloadScanner->end();
+#endif
+
     // do this as long as we don't find matching comment ends
     while ((m_state.inComment() || m_state.inServer()) && m_scriptCode && m_scriptCodeSize) {
         // we've found an unmatched comment start
@@ -1986,6 +2053,10 @@ HTMLTokenizer::~HTMLTokenizer()
 {
     ASSERT(!m_inWrite);
     reset();
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    if (m_backgroundPreloadScanner)
+        m_backgroundPreloadScanner->detach();
+#endif
 }
 
 
@@ -33,10 +33,12 @@
 #include "Tokenizer.h"
 #include <wtf/Deque.h>
 #include <wtf/OwnPtr.h>
+#include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
 
+class BackgroundPreloadScanner;
 class CachedScript;
 class DocumentFragment;
 class Document;
@@ -424,6 +426,9 @@ private:
     FragmentScriptingPermission m_scriptingPermission;
 
     OwnPtr<PreloadScanner> m_preloadScanner;
+#if ENABLE(BACKGROUND_PRELOAD_SCANNER)
+    RefPtr<BackgroundPreloadScanner> m_backgroundPreloadScanner;
+#endif
 };
 
 void parseHTMLDocumentFragment(const String&, DocumentFragment*, FragmentScriptingPermission = FragmentScriptingAllowed);
@@ -27,7 +27,6 @@
 #include "config.h"
 #include "PreloadScanner.h"
 
-#include "AtomicString.h"
 #include "CachedCSSStyleSheet.h"
 #include "CachedImage.h"
 #include "CachedResource.h"
@@ -40,7 +39,6 @@
 #include "Frame.h"
 #include "FrameLoader.h"
 #include "HTMLLinkElement.h"
-#include "HTMLNames.h"
 #include <wtf/CurrentTime.h>
 #include <wtf/unicode/Unicode.h>
 
@@ -63,8 +61,6 @@ using namespace WTF;
 
 namespace WebCore {
     
-using namespace HTMLNames;
-    
 PreloadScanner::PreloadScanner(Document* doc)
     : m_inProgress(false)
     , m_timeUsed(0)
@@ -72,14 +68,16 @@ PreloadScanner::PreloadScanner(Document* doc)
     , m_document(doc)
 {
 #if PRELOAD_DEBUG
-    printf("CREATING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
+    if (m_document)
+        printf("CREATING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
 #endif
 }
     
 PreloadScanner::~PreloadScanner()
 {
 #if PRELOAD_DEBUG
-    printf("DELETING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
+    if (m_document)
+        printf("DELETING PRELOAD SCANNER FOR %s\n", m_document->url().string().latin1().data());
     printf("TOTAL TIME USED %.4fs\n", m_timeUsed);
 #endif
 }
@@ -110,7 +108,8 @@ void PreloadScanner::reset()
     m_tagName.clear();
     m_attributeName.clear();
     m_attributeValue.clear();
-    m_lastStartTag = AtomicString();
+    m_lastStartTag = String();
+    m_lastStartTagIsStyle = false;
     
     m_urlToLoad = String();
     m_charset = String();
@@ -125,7 +124,13 @@ void PreloadScanner::reset()
     
 bool PreloadScanner::scanningBody() const
 {
-    return m_document->body() || m_bodySeen;
+    return (m_document && m_document->body()) || m_bodySeen;
+}
+
+void PreloadScanner::takePreloadRequests(Vector<PreloadRequest>& requests)
+{
+    requests.swap(m_preloadRequests);
+    m_preloadRequests.clear();
 }
     
 void PreloadScanner::write(const SegmentedString& source)
@@ -143,6 +148,20 @@ static inline bool isWhitespace(UChar c)
 {
     return c == ' ' || c == '\n' || c == '\r' || c == '\t';
 }
+
+// Tag and attribute names are lowercased as they are tokenized. They are compared
+// against literals rather than the HTMLNames atoms so that the scanner can run on
+// threads other than the main one.
+template<size_t inlineCapacity>
+static inline bool nameEquals(const Vector<UChar, inlineCapacity>& name, const char* literal)
+{
+    size_t length = name.size();
+    for (size_t i = 0; i < length; ++i) {
+        if (!literal[i] || name[i] != static_cast<unsigned char>(literal[i]))
+            return false;
+    }
+    return !literal[length];
+}
     
 inline void PreloadScanner::clearLastCharacters()
 {
@@ -690,19 +709,16 @@ void PreloadScanner::tokenize(const SegmentedString& source)
     
 void PreloadScanner::processAttribute()
 {
-    AtomicString tag = AtomicString(m_tagName.data(), m_tagName.size());
-    AtomicString attribute = AtomicString(m_attributeName.data(), m_attributeName.size());
-    
     String value(m_attributeValue.data(), m_attributeValue.size());
-    if (tag == scriptTag || tag == imgTag) {
-        if (attribute == srcAttr && m_urlToLoad.isEmpty())
+    if (nameEquals(m_tagName, "script") || nameEquals(m_tagName, "img")) {
+        if (nameEquals(m_attributeName, "src") && m_urlToLoad.isEmpty())
             m_urlToLoad = deprecatedParseURL(value);
-        else if (attribute == charsetAttr)
+        else if (nameEquals(m_attributeName, "charset"))
             m_charset = value;
-    } else if (tag == linkTag) {
-        if (attribute == hrefAttr && m_urlToLoad.isEmpty())
+    } else if (nameEquals(m_tagName, "link")) {
+        if (nameEquals(m_attributeName, "href") && m_urlToLoad.isEmpty())
             m_urlToLoad = deprecatedParseURL(value);
-        else if (attribute == relAttr) {
+        else if (nameEquals(m_attributeName, "rel")) {
             bool styleSheet = false;
             bool alternate = false;
             bool icon = false;
@@ -716,14 +732,29 @@ void PreloadScanner::processAttribute()
             HTMLLinkElement::tokenizeRelAttribute(value, styleSheet, alternate, icon, dnsPrefetch);
             m_linkIsStyleSheet = styleSheet && !alternate && !icon && !dnsPrefetch;
 #endif
-        } else if (attribute == charsetAttr)
+        } else if (nameEquals(m_attributeName, "charset"))
             m_charset = value;
     }
 }
+
+void PreloadScanner::preload(CachedResource::Type type, const String& url, const String& charset)
+{
+    if (m_document) {
+        m_document->docLoader()->preload(type, url, charset, scanningBody());
+        return;
+    }
+
+    PreloadRequest request;
+    request.type = type;
+    request.url = url;
+    request.charset = charset;
+    request.inBody = m_bodySeen;
+    m_preloadRequests.append(request);
+}
     
 inline void PreloadScanner::emitCharacter(UChar c)
 {
-    if (m_contentModel == CDATA && m_lastStartTag == styleTag) 
+    if (m_contentModel == CDATA && m_lastStartTagIsStyle)
         tokenizeCSS(c);
 }
     
@@ -815,22 +846,22 @@ void PreloadScanner::emitTag()
         return;
     }
     
-    AtomicString tag(m_tagName.data(), m_tagName.size());
-    m_lastStartTag = tag;
+    m_lastStartTag = String(m_tagName.data(), m_tagName.size());
+    m_lastStartTagIsStyle = nameEquals(m_tagName, "style");
     
-    if (tag == textareaTag || tag == titleTag)
+    if (nameEquals(m_tagName, "textarea") || nameEquals(m_tagName, "title"))
         m_contentModel = RCDATA;
-    else if (tag == styleTag || tag == xmpTag || tag == scriptTag || tag == iframeTag || tag == noembedTag || tag == noframesTag)
+    else if (m_lastStartTagIsStyle || nameEquals(m_tagName, "xmp") || nameEquals(m_tagName, "script") || nameEquals(m_tagName, "iframe") || nameEquals(m_tagName, "noembed") || nameEquals(m_tagName, "noframes"))
         m_contentModel = CDATA;
-    else if (tag == noscriptTag)
+    else if (nameEquals(m_tagName, "noscript"))
         // we wouldn't be here if scripts were disabled
         m_contentModel = CDATA;
-    else if (tag == plaintextTag)
+    else if (nameEquals(m_tagName, "plaintext"))
         m_contentModel = PLAINTEXT;
     else
         m_contentModel = PCDATA;
     
-    if (tag == bodyTag)
+    if (nameEquals(m_tagName, "body"))
         m_bodySeen = true;
     
     if (m_urlToLoad.isEmpty()) {
@@ -838,12 +869,12 @@ void PreloadScanner::emitTag()
         return;
     }
     
-    if (tag == scriptTag)
-        m_document->docLoader()->preload(CachedResource::Script, m_urlToLoad, m_charset, scanningBody());
-    else if (tag == imgTag) 
-        m_document->docLoader()->preload(CachedResource::ImageResource, m_urlToLoad, String(), scanningBody());
-    else if (tag == linkTag && m_linkIsStyleSheet) 
-        m_document->docLoader()->preload(CachedResource::CSSStyleSheet, m_urlToLoad, m_charset, scanningBody());
+    if (nameEquals(m_tagName, "script"))
+        preload(CachedResource::Script, m_urlToLoad, m_charset);
+    else if (nameEquals(m_tagName, "img"))
+        preload(CachedResource::ImageResource, m_urlToLoad, String());
+    else if (nameEquals(m_tagName, "link") && m_linkIsStyleSheet)
+        preload(CachedResource::CSSStyleSheet, m_urlToLoad, m_charset);
 
     m_urlToLoad = String();
     m_charset = String();
@@ -857,7 +888,7 @@ void PreloadScanner::emitCSSRule()
         String value(m_cssRuleValue.data(), m_cssRuleValue.size());
         String url = deprecatedParseURL(value);
         if (!url.isEmpty())
-            m_document->docLoader()->preload(CachedResource::CSSStyleSheet, url, String(), scanningBody());
+            preload(CachedResource::CSSStyleSheet, url, String());
     }
     m_cssRule.clear();
     m_cssRuleValue.clear();
@@ -26,17 +26,27 @@
 #ifndef PreloadScanner_h
 #define PreloadScanner_h
 
-#include "AtomicString.h"
+#include "CachedResource.h"
+#include "PlatformString.h"
 #include "SegmentedString.h"
 #include <wtf/Noncopyable.h>
 #include <wtf/Vector.h>
 
 namespace WebCore {
     
-    class CachedResource;
     class CachedResourceClient;
     class Document;
+
+    struct PreloadRequest {
+        CachedResource::Type type;
+        String url;
+        String charset;
+        bool inBody;
+    };
     
+    // A PreloadScanner created without a document does not touch any main thread
+    // state and can run on a background thread; the preloads it finds are queued
+    // and handed out by takePreloadRequests() instead of being issued directly.
     class PreloadScanner : public Noncopyable {
     public:
         PreloadScanner(Document*);
@@ -47,6 +57,8 @@ namespace WebCore {
         bool inProgress() const { return m_inProgress; }
         
         bool scanningBody() const;
+
+        void takePreloadRequests(Vector<PreloadRequest>&);
         
         static unsigned consumeEntity(SegmentedString&, bool& notEnoughCharacters);
         
@@ -61,6 +73,7 @@ namespace WebCore {
         void emitCSSRule();
         
         void processAttribute();
+        void preload(CachedResource::Type, const String& url, const String& charset);
 
         
         void clearLastCharacters();
@@ -112,7 +125,8 @@ namespace WebCore {
         Vector<UChar, 32> m_tagName;
         Vector<UChar, 32> m_attributeName;
         Vector<UChar> m_attributeValue;
-        AtomicString m_lastStartTag;
+        String m_lastStartTag;
+        bool m_lastStartTagIsStyle;
         
         String m_urlToLoad;
         String m_charset;
@@ -137,6 +151,7 @@ namespace WebCore {
         
         bool m_bodySeen;
         Document* m_document;
+        Vector<PreloadRequest> m_preloadRequests;
     };
 
 }
@@ -27,6 +27,7 @@
 #include "config.h"
 #include "CachedCSSStyleSheet.h"
 
+#include "BackgroundCSSTokenizer.h"
 #include "CachedResourceClient.h"
 #include "CachedResourceClientWalker.h"
 #include "HTTPParsers.h"
@@ -47,6 +48,10 @@ CachedCSSStyleSheet::CachedCSSStyleSheet(const String& url, const String& charse
 
 CachedCSSStyleSheet::~CachedCSSStyleSheet()
 {
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+    if (m_backgroundTokenizer)
+        m_backgroundTokenizer->detach();
+#endif
 }
 
 void CachedCSSStyleSheet::didAddClient(CachedResourceClient *c)
@@ -57,6 +62,10 @@ void CachedCSSStyleSheet::didAddClient(CachedResourceClient *c)
 
 void CachedCSSStyleSheet::allClientsRemoved()
 {
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+    if (m_backgroundTokenizer)
+        return;
+#endif
     if (isSafeToMakePurgeable())
         makePurgeable(true);
 }
@@ -99,12 +108,36 @@ void CachedCSSStyleSheet::data(PassRefPtr<SharedBuffer> data, bool allDataReceiv
         m_decodedSheetText = m_decoder->decode(m_data->data(), m_data->size());
         m_decodedSheetText += m_decoder->flush();
     }
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+    if (BackgroundCSSTokenizer::shouldTokenize(m_decodedSheetText)) {
+        // Clients are notified from tokenizationFinished(), so the main
+        // thread can get on with other work while the text is scanned.
+        m_backgroundTokenizer = BackgroundCSSTokenizer::create(this, m_decodedSheetText);
+        return;
+    }
+#endif
     m_loading = false;
     checkNotify();
     // Clear the decoded text as it is unlikely to be needed immediately again and is cheap to regenerate.
     m_decodedSheetText = String();
 }
 
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+void CachedCSSStyleSheet::tokenizationFinished()
+{
+    RefPtr<BackgroundCSSTokenizer> tokenizer = m_backgroundTokenizer.release();
+    tokenizer->detach();
+
+    // Clients parsing the text while they are notified get the tokens. Like
+    // the decoded text, they are dropped afterwards.
+    m_loading = false;
+    tokenizer->setSheetText(m_decodedSheetText);
+    checkNotify();
+    tokenizer->clearSheetText();
+    m_decodedSheetText = String();
+}
+#endif
+
 void CachedCSSStyleSheet::checkNotify()
 {
     if (m_loading)
@@ -32,6 +32,7 @@
 
 namespace WebCore {
 
+    class BackgroundCSSTokenizer;
     class DocLoader;
     class TextResourceDecoder;
 
@@ -54,9 +55,18 @@ namespace WebCore {
         virtual bool schedule() const { return true; }
 
         void checkNotify();
+
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+        void tokenizationFinished();
+#endif
     
     private:
         bool canUseSheet(bool enforceMIMEType, bool* hasValidMIMEType) const;
+#if ENABLE(BACKGROUND_CSS_TOKENIZER)
+        // Keeps the sheet loading, and its clients waiting, until the text
+        // has been tokenized on the background thread.
+        RefPtr<BackgroundCSSTokenizer> m_backgroundTokenizer;
+#endif
 
     protected:
         RefPtr<TextResourceDecoder> m_decoder;
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ASCIIFastPath_h
+#define ASCIIFastPath_h
+
+#include <wtf/unicode/Unicode.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ASCII_FAST_PATH_SSE2 1
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ASCII_FAST_PATH_NEON 1
+#endif
+
+// Scanning and widening loops for the tokenizer and the text decoders. They work on
+// 16 bytes at a time when the compiler targets SSE2 or NEON, and fall back to plain
+// loops otherwise.
+
+namespace WebCore {
+
+#if defined(ASCII_FAST_PATH_NEON)
+// The index of the first lane set in a mask of eight 16-bit comparison results.
+inline int firstSetLane(uint16x8_t mask)
+{
+    uint64_t narrowed = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(mask)), 0);
+    return narrowed ? __builtin_ctzll(narrowed) / 8 : -1;
+}
+#endif
+
+// Returns the index of the first character that is a, b, c or d, or length if there is none.
+inline size_t findFirstOf(const UChar* characters, size_t length, UChar a, UChar b, UChar c, UChar d)
+{
+    size_t i = 0;
+#if defined(ASCII_FAST_PATH_SSE2)
+    const __m128i va = _mm_set1_epi16(a);
+    const __m128i vb = _mm_set1_epi16(b);
+    const __m128i vc = _mm_set1_epi16(c);
+    const __m128i vd = _mm_set1_epi16(d);
+    for (; i + 8 <= length; i += 8) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(characters + i));
+        __m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(chunk, va), _mm_cmpeq_epi16(chunk, vb)),
+                                       _mm_or_si128(_mm_cmpeq_epi16(chunk, vc), _mm_cmpeq_epi16(chunk, vd)));
+        if (int mask = _mm_movemask_epi8(matches))
+            return i + __builtin_ctz(mask) / 2;
+    }
+#elif defined(ASCII_FAST_PATH_NEON)
+    const uint16x8_t va = vdupq_n_u16(a);
+    const uint16x8_t vb = vdupq_n_u16(b);
+    const uint16x8_t vc = vdupq_n_u16(c);
+    const uint16x8_t vd = vdupq_n_u16(d);
+    for (; i + 8 <= length; i += 8) {
+        uint16x8_t chunk = vld1q_u16(characters + i);
+        uint16x8_t matches = vorrq_u16(vorrq_u16(vceqq_u16(chunk, va), vceqq_u16(chunk, vb)),
+                                       vorrq_u16(vceqq_u16(chunk, vc), vceqq_u16(chunk, vd)));
+        int lane = firstSetLane(matches);
+        if (lane >= 0)
+            return i + lane;
+    }
+#endif
+    for (; i < length; ++i) {
+        UChar character = characters[i];
+        if (character == a || character == b || character == c || character == d)
+            return i;
+    }
+    return length;
+}
+
+// Returns the index of the first character that is not above the given one, or length
+// if there is none.
+inline size_t findFirstAtOrBelow(const UChar* characters, size_t length, UChar limit)
+{
+    size_t i = 0;
+#if defined(ASCII_FAST_PATH_SSE2)
+    // There is no unsigned 16-bit comparison, but a saturating subtraction only
+    // gives zero for the characters at or below the limit.
+    const __m128i vlimit = _mm_set1_epi16(limit);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= length; i += 8) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(characters + i));
+        if (int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_subs_epu16(chunk, vlimit), zero)))
+            return i + __builtin_ctz(mask) / 2;
+    }
+#elif defined(ASCII_FAST_PATH_NEON)
+    const uint16x8_t vlimit = vdupq_n_u16(limit);
+    for (; i + 8 <= length; i += 8) {
+        int lane = firstSetLane(vcleq_u16(vld1q_u16(characters + i), vlimit));
+        if (lane >= 0)
+            return i + lane;
+    }
+#endif
+    for (; i < length; ++i) {
+        if (characters[i] <= limit)
+            return i;
+    }
+    return length;
+}
+
+// Widens length bytes into UChars and returns true if none of them had the high bit set.
+inline bool widenBytes(const char* bytes, UChar* characters, size_t length)
+{
+    size_t i = 0;
+    unsigned char ored = 0;
+#if defined(ASCII_FAST_PATH_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    int highBits = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        highBits |= _mm_movemask_epi8(chunk);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(characters + i), _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(characters + i + 8), _mm_unpackhi_epi8(chunk, zero));
+    }
+    if (highBits)
+        ored = 0x80;
+#elif defined(ASCII_FAST_PATH_NEON)
+    uint8x16_t oredChunks = vdupq_n_u8(0);
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(bytes + i));
+        oredChunks = vorrq_u8(oredChunks, chunk);
+        vst1q_u16(characters + i, vmovl_u8(vget_low_u8(chunk)));
+        vst1q_u16(characters + i + 8, vmovl_u8(vget_high_u8(chunk)));
+    }
+    uint8x8_t oredHalves = vorr_u8(vget_low_u8(oredChunks), vget_high_u8(oredChunks));
+    if (vget_lane_u64(vreinterpret_u64_u8(oredHalves), 0) & 0x8080808080808080ULL)
+        ored = 0x80;
+#endif
+    for (; i < length; ++i) {
+        unsigned char c = bytes[i];
+        characters[i] = c;
+        ored |= c;
+    }
+    return !(ored & 0x80);
+}
+
+// Widens the leading run of ASCII bytes into UChars and returns how many there were.
+inline size_t widenASCIIPrefix(const char* bytes, UChar* characters, size_t length)
+{
+    size_t i = 0;
+#if defined(ASCII_FAST_PATH_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        if (_mm_movemask_epi8(chunk))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(characters + i), _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(characters + i + 8), _mm_unpackhi_epi8(chunk, zero));
+    }
+#elif defined(ASCII_FAST_PATH_NEON)
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(bytes + i));
+        uint8x8_t oredHalves = vorr_u8(vget_low_u8(chunk), vget_high_u8(chunk));
+        if (vget_lane_u64(vreinterpret_u64_u8(oredHalves), 0) & 0x8080808080808080ULL)
+            break;
+        vst1q_u16(characters + i, vmovl_u8(vget_low_u8(chunk)));
+        vst1q_u16(characters + i + 8, vmovl_u8(vget_high_u8(chunk)));
+    }
+#endif
+    for (; i < length; ++i) {
+        unsigned char c = bytes[i];
+        if (c & 0x80)
+            break;
+        characters[i] = c;
+    }
+    return i;
+}
+
+} // namespace WebCore
+
+#endif // ASCIIFastPath_h
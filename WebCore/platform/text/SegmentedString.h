@@ -147,6 +147,24 @@ public:
         advanceSlowCase(lineNumber);
     }
     
+    // The characters that can be read straight out of the current substring, starting with
+    // the current one. The run is empty while a pushed character has to be read first.
+    const UChar* currentRun(int& length) const
+    {
+        length = m_pushedChar1 ? 0 : m_currentString.m_length;
+        return m_currentChar;
+    }
+
+    // Skips count characters of the current run, none of which may be a newline.
+    void advancePastNonNewlines(int count)
+    {
+        ASSERT(count > 0 && !m_pushedChar1 && count <= m_currentString.m_length);
+        m_currentString.m_length -= count - 1;
+        m_currentString.m_current += count - 1;
+        m_currentChar = m_currentString.m_current;
+        advancePastNonNewline();
+    }
+
     bool escaped() const { return m_pushedChar1; }
     
     String toString() const;
@@ -27,6 +27,7 @@
 #include "config.h"
 #include "TextCodecICU.h"
 
+#include "ASCIIFastPath.h"
 #include "CharacterNames.h"
 #include "CString.h"
 #include "PlatformString.h"
@@ -198,6 +199,8 @@ TextCodecICU::TextCodecICU(const TextEncoding& encoding)
     , m_numBufferedBytes(0)
     , m_converterICU(0)
     , m_needsGBKFallbacks(false)
+    , m_isUTF8(!strcmp(encoding.name(), "UTF-8"))
+    , m_endedOnCharacterBoundary(true)
 {
 }
 
@@ -305,11 +308,19 @@ String TextCodecICU::decode(const char* bytes, size_t length, bool flush, bool s
     ErrorCallbackSetter callbackSetter(m_converterICU, stopOnError);
 
     Vector<UChar> result;
+    size_t asciiLength = 0;
+    if (m_isUTF8 && m_endedOnCharacterBoundary) {
+        result.resize(length);
+        asciiLength = widenASCIIPrefix(bytes, result.data(), length);
+        result.shrink(asciiLength);
+    }
+    if (m_isUTF8 && length)
+        m_endedOnCharacterBoundary = flush || !(bytes[length - 1] & 0x80);
 
     UChar buffer[ConversionBufferSize];
     UChar* bufferLimit = buffer + ConversionBufferSize;
-    const char* source = reinterpret_cast<const char*>(bytes);
-    const char* sourceLimit = source + length;
+    const char* source = reinterpret_cast<const char*>(bytes) + asciiLength;
+    const char* sourceLimit = reinterpret_cast<const char*>(bytes) + length;
     int32_t* offsets = NULL;
     UErrorCode err = U_ZERO_ERROR;
 
@@ -324,6 +335,7 @@ String TextCodecICU::decode(const char* bytes, size_t length, bool flush, bool s
             decodeToBuffer(buffer, bufferLimit, source, sourceLimit, offsets, true, err);
         } while (source < sourceLimit);
         sawError = true;
+        m_endedOnCharacterBoundary = true;
     }
 
     String resultString = String::adopt(result);
@@ -64,6 +64,11 @@ namespace WebCore {
         unsigned char m_bufferedBytes[16]; // bigger than any single multi-byte character
         mutable UConverter* m_converterICU;
         mutable bool m_needsGBKFallbacks;
+
+        // A UTF-8 converter holds no partial character after an ASCII byte, so while
+        // that is where the last chunk ended, leading ASCII can skip the converter.
+        bool m_isUTF8;
+        bool m_endedOnCharacterBoundary;
     };
 
     struct ICUConverterWrapper {
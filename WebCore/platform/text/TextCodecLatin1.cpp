@@ -26,6 +26,7 @@
 #include "config.h"
 #include "TextCodecLatin1.h"
 
+#include "ASCIIFastPath.h"
 #include "CString.h"
 #include "PlatformString.h"
 #include "StringBuffer.h"
@@ -123,14 +124,7 @@ String TextCodecLatin1::decode(const char* bytes, size_t length, bool, bool, boo
     String result = String::createUninitialized(length, characters);
 
     // Convert the string a fast way and simultaneously do an efficient check to see if it's all ASCII.
-    unsigned char ored = 0;
-    for (size_t i = 0; i < length; ++i) {
-        unsigned char c = bytes[i];
-        characters[i] = c;
-        ored |= c;
-    }
-
-    if (!(ored & 0x80))
+    if (widenBytes(bytes, characters, length))
         return result;
 
     // Convert the slightly slower way when there are non-ASCII characters.
@@ -46,6 +46,7 @@ LOCAL_SRC_FILES := \
 	android/jni/MIMETypeRegistry.cpp \
 	android/jni/MockGeolocation.cpp \
 	android/jni/PictureSet.cpp \
+	android/jni/PictureSetTileCache.cpp \
 	android/jni/WebCoreFrameBridge.cpp \
 	android/jni/WebCoreJni.cpp \
 	android/jni/WebCoreResourceLoader.cpp \
@@ -62,6 +63,7 @@ LOCAL_SRC_FILES := \
 	android/nav/CachedInput.cpp \
 	android/nav/CachedLayer.cpp \
 	android/nav/CachedNode.cpp \
+	android/nav/CachedNodeIndex.cpp \
 	android/nav/CachedRoot.cpp \
 	android/nav/FindCanvas.cpp \
 	android/nav/SelectText.cpp \
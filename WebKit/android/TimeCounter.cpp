@@ -28,12 +28,17 @@
 #include "config.h"
 #include "TimeCounter.h"
 
+#include "CSSParser.h"
+#include "CSSStyleSelector.h"
 #include "CString.h"
 #include "Cache.h"
 #include "KURL.h"
 #include "Node.h"
+#include "PictureSetTileCache.h"
 #include "SystemTime.h"
 #include "StyleBase.h"
+#include "StyleRecalcStatistics.h"
+#include "WebViewCore.h"
 #include <utils/Log.h>
 #include <wtf/CurrentTime.h>
 
@@ -42,8 +47,13 @@
 
 #if USE(JSC)
 #include "JSDOMWindow.h"
+#include <parser/ParsedProgramCache.h>
 #include <runtime/JSGlobalObject.h>
 #include <runtime/JSLock.h>
+#include <runtime/MegamorphicCache.h>
+#if ENABLE(YARR_JIT)
+#include <yarr/RegexJIT.h>
+#endif
 #endif
 
 using namespace WebCore;
@@ -143,9 +153,59 @@ void TimeCounter::report(const KURL& url, int live, int dead, size_t arenaSize)
     Heap::Statistics jsHeapStatistics = JSDOMWindow::commonJSGlobalData()->heap.statistics();
     LOGD("Current JavaScript heap size is %d and has %d bytes free",
             jsHeapStatistics.size, jsHeapStatistics.free);
+#if ENABLE(JSC_INCREMENTAL_MARKING)
+    Heap::IncrementalMarkingStatistics markingStatistics = JSDOMWindow::commonJSGlobalData()->heap.incrementalMarkingStatistics();
+    LOGD("JavaScript heap marked incrementally %d times in %d slices, longest pause %.1f ms",
+            markingStatistics.cycles, markingStatistics.slices, markingStatistics.maxPause);
+#endif
+    ParsedProgramCache* parsedProgramCache = JSDOMWindow::commonJSGlobalData()->parsedProgramCache;
+    LOGD("JavaScript parsed program cache has %u hits and %u misses",
+            parsedProgramCache->hits(), parsedProgramCache->misses());
+#if ENABLE(JIT)
+    MegamorphicCache* megamorphicCache = JSDOMWindow::commonJSGlobalData()->megamorphicCache;
+    LOGD("JavaScript megamorphic property cache has %u hits and %u misses",
+            megamorphicCache->hits(), megamorphicCache->misses());
+    const MegamorphicCache::SiteStatistics& siteStatistics = MegamorphicCache::siteStatistics();
+    LOGD("JavaScript megamorphic sites by hit rate: %u under 25%%, %u under 50%%,"
+            " %u under 75%%, %u at 75%% or more, of %u retired sites",
+            siteStatistics.sitesByHitRate[0], siteStatistics.sitesByHitRate[1],
+            siteStatistics.sitesByHitRate[2], siteStatistics.sitesByHitRate[3],
+            siteStatistics.sites);
+#endif
+#if ENABLE(YARR_JIT)
+    const Yarr::RegexJITStatistics& regexStatistics = Yarr::regexJITStatistics();
+    LOGD("JavaScript compiled %u regular expressions, %u to native code",
+            regexStatistics.compiledPatterns, regexStatistics.fallbacks[Yarr::RegexJITFallbackNone]);
+    for (int i = Yarr::RegexJITFallbackNone + 1; i < Yarr::NumberOfRegexJITFallbackReasons; ++i) {
+        if (regexStatistics.fallbacks[i])
+            LOGD("  %u fell back to pcre: %s", regexStatistics.fallbacks[i],
+                    Yarr::regexJITFallbackReasonName(static_cast<Yarr::RegexJITFallbackReason>(i)));
+    }
+#endif
 #endif
     LOGD("Current CSS styles use %d bytes", StyleBase::reportStyleSize());
+    size_t sharedValueSavings = CSSParser::sharedValueSavings();
+    unsigned styleSheetCount = CSSParser::parsedStyleSheetCount();
+    LOGD("Shared CSS values saved %u bytes, %u bytes per style sheet over %u style sheets",
+        static_cast<unsigned>(sharedValueSavings),
+        static_cast<unsigned>(styleSheetCount ? sharedValueSavings / styleSheetCount : 0), styleSheetCount);
+    const CSSStyleSelector::StyleSharingStatistics& sharing = CSSStyleSelector::styleSharingStatistics();
+    LOGD("Style sharing: %u sibling hits, %u cache hits, %u misses",
+        sharing.siblingHits, sharing.cacheHits, sharing.misses);
+    LOGD("%s", StyleRecalcStatistics::dump().utf8().data());
     LOGD("Current DOM nodes use %d bytes", WebCore::Node::reportDOMNodesSize());
+    const PictureSetTileCache::Statistics& tiles = PictureSetTileCache::statistics();
+    LOGD("Picture tiles: %u hits, %u misses, %u invalidated, %u evicted,"
+        " %u rasterized, %u cancelled", tiles.hits, tiles.misses,
+        tiles.invalidated, tiles.evicted, tiles.rasterized, tiles.cancelled);
+    const WebViewCore::RecordStatistics& record = WebViewCore::recordStatistics();
+    LOGD("Content recording: %u updates, %u pictures, %llu pixels recorded,"
+        " %llu average and %llu most per update", record.updates,
+        record.pictures, record.recordedArea,
+        record.updates ? record.recordedArea / record.updates : 0ULL,
+        record.maxUpdateArea);
+    LOGD("Content compacted %u times", record.compactions);
+    WebViewCore::reportContentMemoryUsage();
 }
 
 void TimeCounter::reportNow()
@@ -179,6 +239,7 @@ void TimeCounter::reportNow()
 void TimeCounter::reset() {
     bzero(sTotalTimeUsed, sizeof(sTotalTimeUsed));
     bzero(sCounter, sizeof(sCounter));
+    StyleRecalcStatistics::reset();
     LOGD("*-* Start browser instrument\n");
     sStartTotalTime = currentTime();
     sStartThreadTime = getThreadMsec();
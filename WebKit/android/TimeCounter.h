@@ -70,6 +70,8 @@ public:
     static void reportNow();
     static void reset();
     static void start(enum Type type);
+    static uint32_t totalTime(enum Type type) { return sTotalTimeUsed[type]; }
+    static uint32_t callCount(enum Type type) { return sCounter[type]; }
 private:
     static uint32_t sStartWebCoreThreadTime;
     static uint32_t sEndWebCoreThreadTime;
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// Shared between libwebcore and the webcore_test executable, so only plain
+// C++ types are used here.
+
+namespace android {
+
+struct BenchmarkTiming {
+    // Thread time in ms, taken from the TimeCounter buckets. These are only
+    // filled in when libwebcore is built with ANDROID_INSTRUMENT.
+    int parse;
+    int style;
+    int layout;
+    int javascript;
+    // Thread time in ms spent recording the laid out page into an SkPicture.
+    int record;
+    // Wall clock time in ms from the start of the load until layout settled.
+    int total;
+};
+
+typedef void (*BenchmarkCallback)(int page, int iteration, bool warmup,
+        const BenchmarkTiming&, void* data);
+
+// Returns true if the per-phase counters are available in this build.
+bool benchmarkIsInstrumented();
+
+// Load each of the urls warmup + iterations times into a single offscreen
+// page of the given size, calling back after every load.
+void benchmarkPages(const char* const* urls, int urlCount, int iterations,
+        int warmup, int width, int height, BenchmarkCallback callback,
+        void* data);
+
+struct TextScanTiming {
+    // Throughput in MB/s of the character at a time loops the tokenizer and
+    // decoders used, and of the ASCIIFastPath kernels that replaced them.
+    double scanLoop;
+    double scanKernel;
+    double widenLoop;
+    double widenKernel;
+};
+
+// Time finding markup in, and widening, megabytes of generated text.
+void benchmarkTextScanning(int megabytes, TextScanTiming*);
+
+struct ScrollTiming {
+    int frames;
+    double average; // ms the UI thread spent drawing a frame
+    double longest;
+    int tileHits; // tiles blitted from the tile cache
+    int tileMisses; // tiles drawn from the pictures instead
+};
+
+// Load the url, record the whole page as WebViewCore does, then scroll
+// through it from top to bottom at 60 frames a second, drawing each frame
+// through a PictureSetTileCache whose tiles are rasterized by the given
+// number of threads (0 picks from the number of cores).
+void benchmarkScroll(const char* url, int threads, int width, int height,
+        ScrollTiming*);
+
+struct NavCacheTiming {
+    int nodes; // in the navigation cache, including the document
+    int build; // wall clock time in ms to build the navigation cache
+    double hitTest; // microseconds per CachedRoot::findAt() of a touch
+    int hits; // hit tests that found a node
+};
+
+// Load a generated page of linkCount short links into a page of the given
+// size, then time building its navigation cache and hit testing it at
+// queries points spread over the document.
+void benchmarkNavCache(int linkCount, int queries, int width, int height,
+        NavCacheTiming*);
+
+}
+
+#endif
@@ -25,21 +25,215 @@
 
 #define LOG_TAG "webcore_test"
 
+#include "Benchmark.h"
+
+#include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#include <unistd.h>
 #include <utils/Log.h>
 
 namespace android {
 extern void benchmark(const char*, int, int ,int);
 }
 
+using namespace android;
+
+static const int kPhaseCount = 6;
+static const char* kPhaseNames[kPhaseCount] = {
+    "parse", "style", "layout", "javascript", "record", "total"
+};
+
+static int phaseValue(const BenchmarkTiming& timing, int phase)
+{
+    switch (phase) {
+    case 0: return timing.parse;
+    case 1: return timing.style;
+    case 2: return timing.layout;
+    case 3: return timing.javascript;
+    case 4: return timing.record;
+    default: return timing.total;
+    }
+}
+
+struct PageResults {
+    char* url;
+    BenchmarkTiming* timings;
+    int peakKb;
+};
+
+struct SuiteResults {
+    PageResults* pages;
+    int iterations;
+};
+
+// Returns the high water mark of the resident set in kB, or -1.
+static int peakMemoryKb()
+{
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f)
+        return -1;
+    char line[256];
+    int peak = -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (!strncmp(line, "VmHWM:", 6)) {
+            peak = atoi(line + 6);
+            break;
+        }
+    }
+    fclose(f);
+    return peak;
+}
+
+static void benchmarkCallback(int page, int iteration, bool warmup,
+        const BenchmarkTiming& timing, void* data)
+{
+    SuiteResults* results = static_cast<SuiteResults*>(data);
+    PageResults& result = results->pages[page];
+    if (warmup) {
+        LOGD("%s: warmup %d took %d ms", result.url, iteration, timing.total);
+        return;
+    }
+    LOGD("%s: iteration %d took %d ms", result.url, iteration, timing.total);
+    result.timings[iteration] = timing;
+    // The process high water mark only grows, so this is the peak after the
+    // page and everything loaded before it.
+    result.peakKb = peakMemoryKb();
+}
+
+// Reads one url per line, skipping blank lines and lines starting with '#'.
+// Paths that are not urls are made absolute relative to the manifest.
+static int readManifest(const char* manifest, char*** urls)
+{
+    FILE* f = fopen(manifest, "r");
+    if (!f) {
+        LOGE("Could not open manifest %s", manifest);
+        return -1;
+    }
+    char dir[PATH_MAX];
+    const char* slash = strrchr(manifest, '/');
+    if (manifest[0] != '/') {
+        if (!getcwd(dir, sizeof(dir)))
+            dir[0] = 0;
+        strncat(dir, "/", sizeof(dir) - strlen(dir) - 1);
+    } else
+        dir[0] = 0;
+    if (slash)
+        strncat(dir, manifest, (slash - manifest) + 1);
+
+    int count = 0;
+    int capacity = 0;
+    *urls = 0;
+    char line[PATH_MAX];
+    while (fgets(line, sizeof(line), f)) {
+        char* start = line;
+        while (*start == ' ' || *start == '\t')
+            start++;
+        char* end = start + strlen(start);
+        while (end > start && (end[-1] == '\n' || end[-1] == '\r'
+                || end[-1] == ' ' || end[-1] == '\t'))
+            *--end = 0;
+        if (!*start || *start == '#')
+            continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            *urls = static_cast<char**>(realloc(*urls, capacity * sizeof(char*)));
+        }
+        char* url;
+        if (strstr(start, "://") || !strncmp(start, "data:", 5))
+            url = strdup(start);
+        else {
+            // 7 for file://, 1 for the terminator
+            int length = 7 + (*start == '/' ? 0 : strlen(dir)) + strlen(start) + 1;
+            url = static_cast<char*>(malloc(length));
+            snprintf(url, length, "file://%s%s", *start == '/' ? "" : dir, start);
+        }
+        (*urls)[count++] = url;
+    }
+    fclose(f);
+    return count;
+}
+
+static int compareInts(const void* a, const void* b)
+{
+    return *static_cast<const int*>(a) - *static_cast<const int*>(b);
+}
+
+static void writeJSON(FILE* out, const SuiteResults& results, int urlCount,
+        int warmup, int width, int height)
+{
+    int* values = static_cast<int*>(malloc(results.iterations * sizeof(int)));
+    fprintf(out, "{\n");
+    fprintf(out, "  \"width\": %d,\n  \"height\": %d,\n", width, height);
+    fprintf(out, "  \"iterations\": %d,\n  \"warmup\": %d,\n",
+            results.iterations, warmup);
+    fprintf(out, "  \"instrumented\": %s,\n",
+            benchmarkIsInstrumented() ? "true" : "false");
+    fprintf(out, "  \"peakMemoryKb\": %d,\n", peakMemoryKb());
+    fprintf(out, "  \"pages\": [\n");
+    for (int i = 0; i < urlCount; i++) {
+        const PageResults& page = results.pages[i];
+        fprintf(out, "    {\n      \"url\": \"");
+        for (const char* c = page.url; *c; c++) {
+            if (*c == '"' || *c == '\\')
+                fputc('\\', out);
+            fputc(*c, out);
+        }
+        fprintf(out, "\",\n      \"peakMemoryKb\": %d,\n", page.peakKb);
+        fprintf(out, "      \"phases\": {\n");
+        for (int phase = 0; phase < kPhaseCount; phase++) {
+            long long sum = 0;
+            for (int j = 0; j < results.iterations; j++) {
+                values[j] = phaseValue(page.timings[j], phase);
+                sum += values[j];
+            }
+            qsort(values, results.iterations, sizeof(int), compareInts);
+            fprintf(out, "        \"%s\": { \"min\": %d, \"median\": %d, "
+                    "\"mean\": %.2f, \"max\": %d, \"runs\": [",
+                    kPhaseNames[phase], values[0],
+                    values[results.iterations / 2],
+                    (double) sum / results.iterations,
+                    values[results.iterations - 1]);
+            for (int j = 0; j < results.iterations; j++)
+                fprintf(out, "%s%d", j ? ", " : "",
+                        phaseValue(page.timings[j], phase));
+            fprintf(out, "] }%s\n", phase < kPhaseCount - 1 ? "," : "");
+        }
+        fprintf(out, "      }\n    }%s\n", i < urlCount - 1 ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    free(values);
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-d WIDTHxHEIGHT] [-r RELOADS] FILE\n", name);
+    fprintf(stderr, "       %s [-d WIDTHxHEIGHT] -m MANIFEST [-n ITERATIONS]"
+            " [-w WARMUP] [-o OUTPUT]\n", name);
+    fprintf(stderr, "       %s [-d WIDTHxHEIGHT] -s FILE [-t THREADS]"
+            " [-o OUTPUT]\n", name);
+    fprintf(stderr, "       %s -x MEGABYTES [-o OUTPUT]\n", name);
+    fprintf(stderr, "       %s [-d WIDTHxHEIGHT] -l LINKS [-q QUERIES]"
+            " [-o OUTPUT]\n", name);
+}
+
 int main(int argc, char** argv) {
     int width = 800;
     int height = 600;
     int reloadCount = 0;
+    const char* manifest = 0;
+    const char* output = 0;
+    int iterations = 5;
+    int warmup = 1;
+    int textMegabytes = 0;
+    const char* scrollPage = 0;
+    int threads = 0;
+    int linkCount = 0;
+    int queries = 10000;
     while (true) {
-        int c = getopt(argc, argv, "d:r:");
+        int c = getopt(argc, argv, "d:r:m:n:w:o:x:s:t:l:q:");
         if (c == -1)
             break;
         else if (c == 'd') {
@@ -54,12 +248,134 @@ int main(int argc, char** argv) {
             if (reloadCount < 0)
                 reloadCount = 0;
             LOGD("Reloading %d times", reloadCount);
+        } else if (c == 'm')
+            manifest = optarg;
+        else if (c == 'n') {
+            iterations = atoi(optarg);
+            if (iterations < 1)
+                iterations = 1;
+        } else if (c == 'w') {
+            warmup = atoi(optarg);
+            if (warmup < 0)
+                warmup = 0;
+        } else if (c == 'o')
+            output = optarg;
+        else if (c == 'x')
+            textMegabytes = atoi(optarg);
+        else if (c == 's')
+            scrollPage = optarg;
+        else if (c == 't')
+            threads = atoi(optarg);
+        else if (c == 'l')
+            linkCount = atoi(optarg);
+        else if (c == 'q') {
+            queries = atoi(optarg);
+            if (queries < 1)
+                queries = 1;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (textMegabytes > 0) {
+        TextScanTiming timing;
+        benchmarkTextScanning(textMegabytes, &timing);
+        FILE* out = output ? fopen(output, "w") : stdout;
+        if (!out) {
+            LOGE("Could not open %s for writing\n", output);
+            return 1;
+        }
+        fprintf(out, "{\n  \"megabytes\": %d,\n"
+                "  \"scan\": { \"loopMBs\": %.1f, \"kernelMBs\": %.1f },\n"
+                "  \"widen\": { \"loopMBs\": %.1f, \"kernelMBs\": %.1f }\n}\n",
+                textMegabytes, timing.scanLoop, timing.scanKernel,
+                timing.widenLoop, timing.widenKernel);
+        if (out != stdout)
+            fclose(out);
+        return 0;
+    }
+
+    if (scrollPage) {
+        ScrollTiming timing;
+        benchmarkScroll(scrollPage, threads, width, height, &timing);
+        FILE* out = output ? fopen(output, "w") : stdout;
+        if (!out) {
+            LOGE("Could not open %s for writing\n", output);
+            return 1;
+        }
+        fprintf(out, "{\n  \"url\": \"%s\",\n  \"threads\": %d,\n"
+                "  \"frames\": %d,\n  \"averageMs\": %.2f,\n"
+                "  \"longestMs\": %.2f,\n  \"tileHits\": %d,\n"
+                "  \"tileMisses\": %d\n}\n", scrollPage, threads,
+                timing.frames, timing.average, timing.longest,
+                timing.tileHits, timing.tileMisses);
+        if (out != stdout)
+            fclose(out);
+        return 0;
+    }
+
+    if (linkCount > 0) {
+        NavCacheTiming timing;
+        benchmarkNavCache(linkCount, queries, width, height, &timing);
+        FILE* out = output ? fopen(output, "w") : stdout;
+        if (!out) {
+            LOGE("Could not open %s for writing\n", output);
+            return 1;
         }
+        fprintf(out, "{\n  \"links\": %d,\n  \"nodes\": %d,\n"
+                "  \"buildMs\": %d,\n  \"queries\": %d,\n"
+                "  \"hits\": %d,\n  \"hitTestUs\": %.2f\n}\n", linkCount,
+                timing.nodes, timing.build, queries, timing.hits,
+                timing.hitTest);
+        if (out != stdout)
+            fclose(out);
+        return 0;
     }
-    if (optind >= argc) {
-        LOGE("Please supply a file to read\n");
+
+    if (!manifest) {
+        if (optind >= argc) {
+            LOGE("Please supply a file to read\n");
+            usage(argv[0]);
+            return 1;
+        }
+        android::benchmark(argv[optind], reloadCount, width, height);
+        return 0;
+    }
+
+    char** urls;
+    int urlCount = readManifest(manifest, &urls);
+    if (urlCount <= 0) {
+        LOGE("No pages found in %s\n", manifest);
         return 1;
     }
 
-    android::benchmark(argv[optind], reloadCount, width, height);
+    SuiteResults results;
+    results.iterations = iterations;
+    results.pages = static_cast<PageResults*>(calloc(urlCount, sizeof(PageResults)));
+    for (int i = 0; i < urlCount; i++) {
+        results.pages[i].url = urls[i];
+        results.pages[i].timings = static_cast<BenchmarkTiming*>(
+                calloc(iterations, sizeof(BenchmarkTiming)));
+    }
+
+    benchmarkPages(urls, urlCount, iterations, warmup, width, height,
+            benchmarkCallback, &results);
+
+    FILE* out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        LOGE("Could not open %s for writing\n", output);
+        return 1;
+    }
+    writeJSON(out, results, urlCount, warmup, width, height);
+    if (out != stdout)
+        fclose(out);
+
+    for (int i = 0; i < urlCount; i++) {
+        free(results.pages[i].timings);
+        free(urls[i]);
+    }
+    free(results.pages);
+    free(urls);
+    return 0;
 }
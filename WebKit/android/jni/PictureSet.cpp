@@ -38,11 +38,13 @@
 #include "SkStream.h"
 #include "SyncProxyCanvas.h"
 #include "TimeCounter.h"
+#include <wtf/HashMap.h>
 
 #define MAX_DRAW_TIME 100
 #define MIN_SPLITTABLE 400
+// More pictures than this drawn over others make the set worth compacting.
+#define MAX_OVERDRAWN_PICTURES 32
 
-#if PICTURE_SET_DEBUG
 class MeasureStream : public SkWStream {
 public:
     MeasureStream() : mTotal(0) {}
@@ -52,7 +54,6 @@ public:
     }
     size_t mTotal;
 };
-#endif
 
 namespace android {
 
@@ -472,6 +473,47 @@ bool PictureSet::emptyPicture(SkPicture* picture) const
     return checker.mEmpty;
 }
 
+size_t PictureSet::memoryUsage() const
+{
+    // split pieces may still share the picture they were split from
+    WTF::Vector<const SkPicture*> measured;
+    MeasureStream measure;
+    const Pictures* last = mPictures.end();
+    for (const Pictures* working = mPictures.begin(); working != last; working++) {
+        const SkPicture* picture = working->mPicture;
+        if (picture == NULL || measured.find(picture) != WTF::notFound)
+            continue;
+        measured.append(picture);
+        picture->serialize(&measure);
+    }
+    return measure.mTotal;
+}
+
+/*
+Pictures that are not bases are drawn over older ones, which are still kept
+and drawn underneath. Once enough of the content is drawn more than once,
+recording it again as a single picture saves both memory and drawing time.
+Split pieces are bases, so a set that was split because it drew slowly is not
+put back together.
+*/
+bool PictureSet::needsCompaction() const
+{
+    if (mWidth == 0 || mHeight == 0)
+        return false;
+    int overdrawn = 0;
+    uint64_t overdrawnArea = 0;
+    const Pictures* last = mPictures.end();
+    for (const Pictures* working = mPictures.begin(); working != last; working++) {
+        if (working->mBase)
+            continue;
+        const SkIRect& bounds = working->mArea.getBounds();
+        overdrawnArea += (uint64_t) bounds.width() * bounds.height();
+        overdrawn++;
+    }
+    return overdrawn > MAX_OVERDRAWN_PICTURES
+        || overdrawnArea * 2 > (uint64_t) mWidth * mHeight;
+}
+
 bool PictureSet::isEmpty() const
 {
     const Pictures* last = mPictures.end();
@@ -575,6 +617,35 @@ void PictureSet::setPicture(size_t i, SkPicture* p)
     mPictures[i].mEmpty = emptyPicture(p);
 }
 
+// SkPicture playback is not reentrant, so a set drawn on another thread
+// must not share pictures with one drawn here. Copies the parts of src that
+// draw into area, each with a private copy of its picture.
+void PictureSet::setPlaybackCopy(const PictureSet& src, const SkIRect& area)
+{
+    clear();
+    mWidth = src.mWidth;
+    mHeight = src.mHeight;
+    WTF::HashMap<SkPicture*, SkPicture*> copies;
+    const Pictures* last = src.mPictures.end();
+    for (const Pictures* working = src.mPictures.begin(); working != last; working++) {
+        if (working->mArea.quickReject(area))
+            continue;
+        Pictures copy = *working;
+        if (working->mPicture) {
+            copy.mPicture = copies.get(working->mPicture);
+            if (!copy.mPicture) {
+                copy.mPicture = new SkPicture(*working->mPicture);
+                copies.set(working->mPicture, copy.mPicture);
+            }
+        }
+        add(&copy);
+    }
+    // add() took its own references.
+    WTF::HashMap<SkPicture*, SkPicture*>::iterator end = copies.end();
+    for (WTF::HashMap<SkPicture*, SkPicture*>::iterator it = copies.begin(); it != end; ++it)
+        it->second->unref();
+}
+
 void PictureSet::split(PictureSet* out) const
 {
     dump(__FUNCTION__);
@@ -72,11 +72,14 @@ namespace android {
         static PictureSet* GetNativePictureSet(JNIEnv* env, jobject jpic);
         int height() const { return mHeight; }
         bool isEmpty() const; // returns true if empty or only trivial content
+        size_t memoryUsage() const; // serialized size of the distinct pictures
+        bool needsCompaction() const; // true if much of the content is overdrawn
         bool reuseSubdivided(const SkRegion& );
         void set(const PictureSet& );
         void setDrawTimes(const PictureSet& );
         void setDrawTimes(uint32_t time);
         void setPicture(size_t i, SkPicture* p);
+        void setPlaybackCopy(const PictureSet& src, const SkIRect& area);
         size_t size() const { return mPictures.size(); }
         void split(PictureSet* result) const;
         bool upToDate(size_t i) const { return mPictures[i].mPicture != NULL; }
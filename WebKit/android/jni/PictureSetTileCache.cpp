@@ -0,0 +1,566 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "pictureset"
+
+#include "config.h"
+#include "PictureSetTileCache.h"
+
+#include "PictureSet.h"
+#include "SkCanvas.h"
+#include "SkMatrix.h"
+#include "SkRect.h"
+#include <algorithm>
+#include <stdlib.h>
+#include <unistd.h>
+#include <utils/Log.h>
+#include <wtf/PassRefPtr.h>
+
+// Tiles are square, in device pixels.
+#define TILE_SIZE 256
+// Upper bound on the memory held by the tiles of one view, including those
+// being rasterized.
+#define MAX_CACHE_BYTES (8 * 1024 * 1024)
+#define MAX_TILES (MAX_CACHE_BYTES / (TILE_SIZE * TILE_SIZE * 4))
+// How many tiles around the view are rasterized ahead of time, and how many
+// more in the direction the view scrolls.
+#define PREFETCH_TILES 1
+#define PREFETCH_SCROLL_TILES 2
+#define MAX_RASTER_THREADS 3
+
+namespace android {
+
+static PictureSetTileCache::Statistics s_statistics;
+static int s_rasterThreadCount;
+
+// A tile to be rasterized on a raster thread. Everything but the state and
+// priority, which the pool's mutex guards, belongs to whichever thread owns
+// the job: the UI thread until it is queued, the raster thread while it is
+// Running, and the UI thread again once it is Finished. The job plays back
+// its own copies of the pictures, since the UI thread and other jobs may be
+// drawing the originals at the same time.
+class RasterJob : public WTF::ThreadSafeShared<RasterJob> {
+public:
+    enum State { Queued, Running, Finished, Cancelled };
+
+    RasterJob(int column, int row, SkScalar scale, const PictureSet& content, const SkIRect& contentRect)
+        : m_column(column)
+        , m_row(row)
+        , m_scale(scale)
+        , m_tookTooLong(false)
+        , m_wantedAt(0)
+        , m_state(Queued)
+        , m_priority(0)
+    {
+        m_content.setPlaybackCopy(content, contentRect);
+    }
+
+    void rasterize()
+    {
+        m_bitmap.setConfig(SkBitmap::kARGB_8888_Config, TILE_SIZE, TILE_SIZE);
+        if (!m_bitmap.allocPixels())
+            return;
+        m_bitmap.eraseColor(0);
+        SkCanvas canvas(m_bitmap);
+        canvas.translate(SkIntToScalar(-m_column * TILE_SIZE), SkIntToScalar(-m_row * TILE_SIZE));
+        canvas.scale(m_scale, m_scale);
+        m_tookTooLong = m_content.draw(&canvas);
+        // Free the picture copies on this thread rather than later on the UI
+        // thread.
+        m_content.clear();
+    }
+
+    int m_column;
+    int m_row;
+    SkScalar m_scale;
+    PictureSet m_content;
+    SkBitmap m_bitmap;
+    bool m_tookTooLong;
+    // The last draw that asked for this tile; UI thread only.
+    unsigned m_wantedAt;
+
+    State m_state;
+    // Lower is more urgent.
+    int m_priority;
+};
+
+// Threads shared by all views, created on first use and kept for the life
+// of the process.
+class RasterWorkerPool : public WTF::Noncopyable {
+public:
+    static RasterWorkerPool& shared()
+    {
+        static RasterWorkerPool* pool = new RasterWorkerPool;
+        return *pool;
+    }
+
+    WTF::Mutex& mutex() { return m_mutex; }
+
+    // Called with mutex() held.
+    void append(PassRefPtr<RasterJob> job)
+    {
+        m_queue.append(job);
+        m_condition.signal();
+    }
+
+    // Called with mutex() held, after priorities changed or jobs were
+    // cancelled.
+    void prioritiesChanged() { m_condition.broadcast(); }
+
+private:
+    RasterWorkerPool()
+    {
+        int threads = s_rasterThreadCount;
+        if (threads <= 0) {
+            long cores = sysconf(_SC_NPROCESSORS_ONLN);
+            // Leave a core for the UI and WebCore threads.
+            threads = cores > 1 ? cores - 1 : 1;
+            if (threads > MAX_RASTER_THREADS)
+                threads = MAX_RASTER_THREADS;
+        }
+        for (int i = 0; i < threads; ++i)
+            WTF::createThread(RasterWorkerPool::threadEntryPointCallback, this, "WebCore: Raster");
+    }
+
+    static void* threadEntryPointCallback(void* pool)
+    {
+        static_cast<RasterWorkerPool*>(pool)->threadEntryPoint();
+        return 0;
+    }
+
+    // Removes and returns the most urgent job still wanted. Called with
+    // m_mutex held.
+    PassRefPtr<RasterJob> takeNextJob()
+    {
+        size_t next = notFound;
+        size_t writer = 0;
+        for (size_t i = 0; i < m_queue.size(); ++i) {
+            if (m_queue[i]->m_state == RasterJob::Cancelled)
+                continue;
+            if (next == notFound || m_queue[i]->m_priority < m_queue[next]->m_priority)
+                next = writer;
+            m_queue[writer++] = m_queue[i];
+        }
+        m_queue.shrink(writer);
+        if (next == notFound)
+            return 0;
+        RefPtr<RasterJob> job = m_queue[next];
+        m_queue.remove(next);
+        return job.release();
+    }
+
+    void threadEntryPoint()
+    {
+        while (true) {
+            RefPtr<RasterJob> job;
+            {
+                WTF::MutexLocker locker(m_mutex);
+                while (!(job = takeNextJob()))
+                    m_condition.wait(m_mutex);
+                job->m_state = RasterJob::Running;
+            }
+            job->rasterize();
+            {
+                WTF::MutexLocker locker(m_mutex);
+                if (job->m_state == RasterJob::Running)
+                    job->m_state = RasterJob::Finished;
+            }
+        }
+    }
+
+    WTF::Mutex m_mutex;
+    WTF::ThreadCondition m_condition;
+    WTF::Vector<RefPtr<RasterJob> > m_queue;
+};
+
+const PictureSetTileCache::Statistics& PictureSetTileCache::statistics()
+{
+    return s_statistics;
+}
+
+void PictureSetTileCache::setRasterThreadCount(int count)
+{
+    s_rasterThreadCount = count;
+}
+
+PictureSetTileCache::PictureSetTileCache()
+    : m_scale(0)
+    , m_lastDrawScale(0)
+    , m_drawCount(0)
+    , m_lastOriginX(0)
+    , m_lastOriginY(0)
+    , m_scrollX(0)
+    , m_scrollY(0)
+    , m_takenInvalidateAll(false)
+    , m_pendingInvalidateAll(false)
+{
+}
+
+PictureSetTileCache::~PictureSetTileCache()
+{
+    cancelJobs();
+    clearTiles();
+}
+
+void PictureSetTileCache::invalidate(const SkRegion& region)
+{
+    WTF::MutexLocker locker(m_pendingMutex);
+    m_pendingInval.op(region, SkRegion::kUnion_Op);
+}
+
+void PictureSetTileCache::invalidateAll()
+{
+    WTF::MutexLocker locker(m_pendingMutex);
+    m_pendingInval.setEmpty();
+    m_pendingInvalidateAll = true;
+}
+
+void PictureSetTileCache::takeInvalidations()
+{
+    WTF::MutexLocker locker(m_pendingMutex);
+    if (m_pendingInvalidateAll) {
+        m_takenInval.setEmpty();
+        m_takenInvalidateAll = true;
+    } else if (!m_takenInvalidateAll)
+        m_takenInval.op(m_pendingInval, SkRegion::kUnion_Op);
+    m_pendingInval.setEmpty();
+    m_pendingInvalidateAll = false;
+}
+
+// Changes recorded after the content passed to draw() was copied stay
+// pending, so the tiles made from that content are dropped by a later draw.
+void PictureSetTileCache::applyInvalidations()
+{
+    if (m_takenInvalidateAll) {
+        s_statistics.invalidated += m_tiles.size();
+        cancelJobs();
+        clearTiles();
+    } else if (!m_takenInval.isEmpty())
+        removeTiles(m_takenInval);
+    m_takenInval.setEmpty();
+    m_takenInvalidateAll = false;
+}
+
+SkIRect PictureSetTileCache::contentRect(int column, int row) const
+{
+    // Grown by a pixel to cover anything antialiased across the tile edge.
+    SkRect rect;
+    rect.set(SkIntToScalar(column * TILE_SIZE), SkIntToScalar(row * TILE_SIZE),
+        SkIntToScalar((column + 1) * TILE_SIZE), SkIntToScalar((row + 1) * TILE_SIZE));
+    SkScalar inverse = SkScalarInvert(m_scale);
+    rect.set(SkScalarMul(rect.fLeft, inverse), SkScalarMul(rect.fTop, inverse),
+        SkScalarMul(rect.fRight, inverse), SkScalarMul(rect.fBottom, inverse));
+    SkIRect result;
+    rect.roundOut(&result);
+    result.inset(-1, -1);
+    return result;
+}
+
+void PictureSetTileCache::removeTiles(const SkRegion& inval)
+{
+    size_t writer = 0;
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        Tile* tile = m_tiles[i];
+        if (inval.intersects(contentRect(tile->column, tile->row))) {
+            ++s_statistics.invalidated;
+            delete tile;
+            continue;
+        }
+        m_tiles[writer++] = tile;
+    }
+    m_tiles.shrink(writer);
+
+    // Jobs already handed out play back the old pictures.
+    RasterWorkerPool& pool = RasterWorkerPool::shared();
+    WTF::MutexLocker locker(pool.mutex());
+    writer = 0;
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+        RasterJob* job = m_jobs[i].get();
+        if (inval.intersects(contentRect(job->m_column, job->m_row))) {
+            ++s_statistics.cancelled;
+            job->m_state = RasterJob::Cancelled;
+            continue;
+        }
+        m_jobs[writer++] = m_jobs[i];
+    }
+    m_jobs.shrink(writer);
+}
+
+void PictureSetTileCache::clearTiles()
+{
+    deleteAllValues(m_tiles);
+    m_tiles.clear();
+}
+
+void PictureSetTileCache::cancelJobs()
+{
+    if (m_jobs.isEmpty())
+        return;
+    RasterWorkerPool& pool = RasterWorkerPool::shared();
+    WTF::MutexLocker locker(pool.mutex());
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+        if (m_jobs[i]->m_state != RasterJob::Finished)
+            ++s_statistics.cancelled;
+        m_jobs[i]->m_state = RasterJob::Cancelled;
+    }
+    m_jobs.clear();
+}
+
+// Moves the tiles the raster threads are done with into the cache. Returns
+// true if one of them took long enough to draw that the content should be
+// split.
+bool PictureSetTileCache::adoptFinishedTiles()
+{
+    if (m_jobs.isEmpty())
+        return false;
+    WTF::Vector<RefPtr<RasterJob> > finished;
+    {
+        RasterWorkerPool& pool = RasterWorkerPool::shared();
+        WTF::MutexLocker locker(pool.mutex());
+        size_t writer = 0;
+        for (size_t i = 0; i < m_jobs.size(); ++i) {
+            if (m_jobs[i]->m_state == RasterJob::Finished)
+                finished.append(m_jobs[i]);
+            else
+                m_jobs[writer++] = m_jobs[i];
+        }
+        m_jobs.shrink(writer);
+    }
+
+    bool tookTooLong = false;
+    for (size_t i = 0; i < finished.size(); ++i) {
+        RasterJob* job = finished[i].get();
+        if (job->m_tookTooLong)
+            tookTooLong = true;
+        if (!job->m_bitmap.getPixels())
+            continue;
+        ++s_statistics.rasterized;
+        Tile* tile = new Tile;
+        tile->column = job->m_column;
+        tile->row = job->m_row;
+        tile->bitmap.swap(job->m_bitmap);
+        tile->lastUsed = m_drawCount;
+        m_tiles.append(tile);
+    }
+    return tookTooLong;
+}
+
+PictureSetTileCache::Tile* PictureSetTileCache::findTile(int column, int row)
+{
+    for (size_t i = 0; i < m_tiles.size(); ++i) {
+        Tile* tile = m_tiles[i];
+        if (tile->column == column && tile->row == row)
+            return tile;
+    }
+    return 0;
+}
+
+RasterJob* PictureSetTileCache::findJob(int column, int row)
+{
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+        RasterJob* job = m_jobs[i].get();
+        if (job->m_column == column && job->m_row == row)
+            return job;
+    }
+    return 0;
+}
+
+// Evicts the least recently used tile if the budget is used up, as long as
+// it is not one this draw needs.
+bool PictureSetTileCache::makeRoomForTile()
+{
+    if (m_tiles.size() + m_jobs.size() < MAX_TILES)
+        return true;
+    if (m_tiles.isEmpty())
+        return false;
+    size_t oldest = 0;
+    for (size_t i = 1; i < m_tiles.size(); ++i) {
+        if (m_tiles[i]->lastUsed < m_tiles[oldest]->lastUsed)
+            oldest = i;
+    }
+    if (m_tiles[oldest]->lastUsed == m_drawCount)
+        return false;
+    ++s_statistics.evicted;
+    delete m_tiles[oldest];
+    m_tiles.remove(oldest);
+    return true;
+}
+
+// Called with the pool's mutex held.
+void PictureSetTileCache::requestTile(int column, int row, int priority, const PictureSet& content)
+{
+    if (findTile(column, row))
+        return;
+    if (RasterJob* job = findJob(column, row)) {
+        job->m_priority = priority;
+        job->m_wantedAt = m_drawCount;
+        return;
+    }
+    if (!makeRoomForTile())
+        return;
+    RefPtr<RasterJob> job = adoptRef(new RasterJob(column, row, m_scale, content, contentRect(column, row)));
+    job->m_priority = priority;
+    job->m_wantedAt = m_drawCount;
+    m_jobs.append(job);
+    RasterWorkerPool::shared().append(job.release());
+}
+
+// Jobs for tiles that scrolled out of reach before a raster thread got to
+// them are dropped. Called with the pool's mutex held.
+void PictureSetTileCache::cancelUnwantedJobs()
+{
+    size_t writer = 0;
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+        RasterJob* job = m_jobs[i].get();
+        if (job->m_wantedAt != m_drawCount && job->m_state == RasterJob::Queued) {
+            ++s_statistics.cancelled;
+            job->m_state = RasterJob::Cancelled;
+            continue;
+        }
+        m_jobs[writer++] = m_jobs[i];
+    }
+    m_jobs.shrink(writer);
+}
+
+static inline int sign(int value)
+{
+    return value > 0 ? 1 : value < 0 ? -1 : 0;
+}
+
+bool PictureSetTileCache::draw(SkCanvas* canvas, PictureSet& content, bool invertColor)
+{
+    applyInvalidations();
+    bool tookTooLong = adoptFinishedTiles();
+
+    // Only plain scrolled and zoomed content is cached. Color inversion also
+    // fills the area around the content, so it is drawn directly too.
+    const SkMatrix matrix = canvas->getTotalMatrix();
+    SkScalar scale = matrix.getScaleX();
+    if (invertColor || scale <= 0 || scale != matrix.getScaleY()
+            || (matrix.getType() & ~(SkMatrix::kScale_Mask | SkMatrix::kTranslate_Mask)))
+        return content.draw(canvas, invertColor) || tookTooLong;
+
+    // While the scale changes from one draw to the next the view is being
+    // zoomed, and tiles made now would not be used again.
+    if (scale != m_lastDrawScale) {
+        m_lastDrawScale = scale;
+        return content.draw(canvas) || tookTooLong;
+    }
+    if (scale != m_scale) {
+        s_statistics.evicted += m_tiles.size();
+        cancelJobs();
+        clearTiles();
+        m_scale = scale;
+    }
+
+    SkRect contentBounds;
+    contentBounds.set(0, 0, SkIntToScalar(content.width()), SkIntToScalar(content.height()));
+    SkRect deviceContentBounds;
+    matrix.mapRect(&deviceContentBounds, contentBounds);
+    SkIRect visible;
+    deviceContentBounds.round(&visible);
+    if (!visible.intersect(canvas->getTotalClip().getBounds()))
+        return tookTooLong;
+
+    ++m_drawCount;
+    // Tiles are placed on the grid of whole device pixels the translation
+    // falls in, and drawn at its exact offset.
+    SkScalar translateX = matrix.getTranslateX();
+    SkScalar translateY = matrix.getTranslateY();
+    int originX = SkScalarFloor(translateX);
+    int originY = SkScalarFloor(translateY);
+    // The content moves the opposite way to the view.
+    if (originX != m_lastOriginX || originY != m_lastOriginY) {
+        m_scrollX = sign(m_lastOriginX - originX);
+        m_scrollY = sign(m_lastOriginY - originY);
+        m_lastOriginX = originX;
+        m_lastOriginY = originY;
+    }
+    int firstColumn = (visible.fLeft - originX) / TILE_SIZE;
+    int lastColumn = (visible.fRight - 1 - originX) / TILE_SIZE;
+    int firstRow = (visible.fTop - originY) / TILE_SIZE;
+    int lastRow = (visible.fBottom - 1 - originY) / TILE_SIZE;
+
+    SkRegion uncached;
+    canvas->save();
+    canvas->clipRect(contentBounds);
+    canvas->resetMatrix();
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int column = firstColumn; column <= lastColumn; ++column) {
+            if (Tile* tile = findTile(column, row)) {
+                ++s_statistics.hits;
+                tile->lastUsed = m_drawCount;
+                canvas->drawBitmap(tile->bitmap, translateX + SkIntToScalar(column * TILE_SIZE),
+                    translateY + SkIntToScalar(row * TILE_SIZE));
+                continue;
+            }
+            ++s_statistics.misses;
+            int x = originX + column * TILE_SIZE;
+            int y = originY + row * TILE_SIZE;
+            // A pixel wider to cover the fraction of the translation.
+            SkIRect deviceRect;
+            deviceRect.set(x, y, x + TILE_SIZE + 1, y + TILE_SIZE + 1);
+            uncached.op(deviceRect, SkRegion::kUnion_Op);
+        }
+    }
+    if (!uncached.isEmpty()) {
+        // Tiles not rasterized yet are played back in one go.
+        canvas->clipRegion(uncached);
+        canvas->setMatrix(matrix);
+        if (content.draw(canvas))
+            tookTooLong = true;
+    }
+    canvas->restore();
+
+    // Hand the missing tiles to the raster threads, nearest to the view
+    // first. Tiles ahead of the scroll count as one step closer.
+    int lastContentColumn = (SkScalarRound(content.width() * scale) - 1) / TILE_SIZE;
+    int lastContentRow = (SkScalarRound(content.height() * scale) - 1) / TILE_SIZE;
+    int prefetchLeft = PREFETCH_TILES + (m_scrollX < 0 ? PREFETCH_SCROLL_TILES : 0);
+    int prefetchRight = PREFETCH_TILES + (m_scrollX > 0 ? PREFETCH_SCROLL_TILES : 0);
+    int prefetchTop = PREFETCH_TILES + (m_scrollY < 0 ? PREFETCH_SCROLL_TILES : 0);
+    int prefetchBottom = PREFETCH_TILES + (m_scrollY > 0 ? PREFETCH_SCROLL_TILES : 0);
+    int startColumn = std::max(firstColumn - prefetchLeft, 0);
+    int endColumn = std::min(lastColumn + prefetchRight, lastContentColumn);
+    int startRow = std::max(firstRow - prefetchTop, 0);
+    int endRow = std::min(lastRow + prefetchBottom, lastContentRow);
+    RasterWorkerPool& pool = RasterWorkerPool::shared();
+    WTF::MutexLocker locker(pool.mutex());
+    for (int row = startRow; row <= endRow; ++row) {
+        for (int column = startColumn; column <= endColumn; ++column) {
+            int dx = column < firstColumn ? column - firstColumn : column > lastColumn ? column - lastColumn : 0;
+            int dy = row < firstRow ? row - firstRow : row > lastRow ? row - lastRow : 0;
+            int priority = 2 * std::max(abs(dx), abs(dy));
+            if (priority && ((dx && sign(dx) == m_scrollX) || (dy && sign(dy) == m_scrollY)))
+                --priority;
+            requestTile(column, row, priority, content);
+        }
+    }
+    cancelUnwantedJobs();
+    pool.prioritiesChanged();
+    return tookTooLong;
+}
+
+} // namespace android
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PictureSetTileCache_h
+#define PictureSetTileCache_h
+
+#include "SkBitmap.h"
+#include "SkRegion.h"
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+
+class SkCanvas;
+class SkMatrix;
+
+namespace android {
+
+class PictureSet;
+class RasterJob;
+
+// Keeps the page content rasterized into fixed size tiles between UI thread
+// draws, so that scrolling blits bitmaps instead of replaying every picture
+// that overlaps the view. Tiles are kept for a single zoom scale, and are
+// dropped only where recorded content changes or to stay within the memory
+// budget.
+//
+// Tiles are rasterized by a pool of worker threads, visible ones first, then
+// those around the view, favoring the direction it scrolls in. The draw
+// thread never waits for them: until a tile is ready its area is drawn from
+// the pictures directly, and finished tiles are picked up by the next draw.
+class PictureSetTileCache : public WTF::Noncopyable {
+public:
+    struct Statistics {
+        unsigned hits;
+        unsigned misses;
+        unsigned invalidated;
+        unsigned evicted;
+        unsigned rasterized;
+        unsigned cancelled;
+    };
+
+    PictureSetTileCache();
+    ~PictureSetTileCache();
+
+    // Called on the WebCore thread when content in the region (in content
+    // coordinates) has been recorded again.
+    void invalidate(const SkRegion&);
+    void invalidateAll();
+
+    // Called on the UI thread while holding the lock that guards the content
+    // and the calls to invalidate(), when copying the content for draw().
+    // The next draw() applies the invalidations taken here, so its tiles are
+    // made from content that includes every change it has dropped tiles for.
+    void takeInvalidations();
+
+    // Called on the UI thread in place of PictureSet::draw(), and returns
+    // the same.
+    bool draw(SkCanvas*, PictureSet&, bool invertColor);
+
+    // Sum over all caches.
+    static const Statistics& statistics();
+
+    // Overrides the number of raster threads, otherwise picked from the
+    // number of cores. Has no effect once any cache has drawn.
+    static void setRasterThreadCount(int);
+
+private:
+    struct Tile {
+        int column;
+        int row;
+        SkBitmap bitmap;
+        unsigned lastUsed;
+    };
+
+    void applyInvalidations();
+    bool adoptFinishedTiles();
+    void removeTiles(const SkRegion&);
+    void clearTiles();
+    void cancelJobs();
+    Tile* findTile(int column, int row);
+    RasterJob* findJob(int column, int row);
+    bool makeRoomForTile();
+    void requestTile(int column, int row, int priority, const PictureSet&);
+    void cancelUnwantedJobs();
+    SkIRect contentRect(int column, int row) const;
+
+    // Only touched on the UI thread.
+    WTF::Vector<Tile*> m_tiles;
+    // Tiles handed to the raster threads and not picked up yet.
+    WTF::Vector<RefPtr<RasterJob> > m_jobs;
+    SkScalar m_scale;
+    SkScalar m_lastDrawScale;
+    unsigned m_drawCount;
+    int m_lastOriginX;
+    int m_lastOriginY;
+    int m_scrollX;
+    int m_scrollY;
+
+    // Content changes taken by takeInvalidations() and not yet applied to
+    // the tiles; UI thread only.
+    SkRegion m_takenInval;
+    bool m_takenInvalidateAll;
+
+    // Content changes not taken yet.
+    WTF::Mutex m_pendingMutex;
+    SkRegion m_pendingInval;
+    bool m_pendingInvalidateAll;
+};
+
+} // namespace android
+
+#endif // PictureSetTileCache_h
@@ -99,6 +99,7 @@
 #include "GCController.h"
 #include "JSDOMWindow.h"
 #include "JavaInstanceJSC.h"
+#include <parser/ParsedProgramCache.h>
 #include <runtime_object.h>
 #include <runtime_root.h>
 #include <runtime/JSLock.h>
@@ -1459,6 +1460,11 @@ static void ClearCache(JNIEnv *env, jobject obj)
     WebCore::pageCache()->setCapacity(pageCapacity);
 
 #if USE(JSC)    
+    // drop the syntax trees kept for scripts that are loaded again
+    {
+        JSC::JSLock lock(false);
+        WebCore::JSDOMWindow::commonJSGlobalData()->parsedProgramCache->clear();
+    }
     // force JavaScript to GC when clear cache
     WebCore::gcController().garbageCollectSoon();
 #elif USE(V8)
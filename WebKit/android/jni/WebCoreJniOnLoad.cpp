@@ -27,7 +27,11 @@
 
 #include "config.h"
 
+#include "ASCIIFastPath.h"
 #include "BackForwardList.h"
+#include "CacheBuilder.h"
+#include "CachedHistory.h"
+#include "CachedRoot.h"
 #include "ChromeClientAndroid.h"
 #include "ContextMenuClientAndroid.h"
 #include "CookieClient.h"
@@ -43,6 +47,8 @@
 #include "IntRect.h"
 #include "JavaSharedClient.h"
 #include "Page.h"
+#include "PictureSet.h"
+#include "PictureSetTileCache.h"
 #include "PlatformGraphicsContext.h"
 #include "ResourceRequest.h"
 #include "ScriptController.h"
@@ -53,18 +59,23 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkImageEncoder.h"
+#include "SkPicture.h"
 #include "SubstituteData.h"
+#include "TimeCounter.h"
 #include "TimerClient.h"
 #include "TextEncoding.h"
 #include "WebCoreViewBridge.h"
 #include "WebFrameView.h"
 #include "WebViewCore.h"
+#include "benchmark/Benchmark.h"
 #include "benchmark/Intercept.h"
 #include "benchmark/MyJavaVM.h"
 
 #include <JNIUtility.h>
 #include <jni.h>
+#include <unistd.h>
 #include <utils/Log.h>
+#include <wtf/CurrentTime.h>
 
 namespace android {
 
@@ -168,7 +179,38 @@ static void historyItemChanged(HistoryItem* i) {
 
 namespace android {
 
-EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
+// Owns the offscreen Page and Frame that the benchmark loads pages into.
+class BenchmarkPage {
+public:
+    BenchmarkPage(int width, int height);
+    ~BenchmarkPage();
+
+    // Load the url and run timers and layout until the page settles.
+    void load(const char* url);
+    // Same, for a page given as html text.
+    void loadHTML(const char* html, size_t length);
+    void reload();
+    // Paint the laid out page, or part of it, into the given canvas.
+    void paint(SkCanvas*);
+    void paint(SkCanvas*, const IntRect&);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+private:
+    void settle();
+
+    MyJavaSharedClient m_client;
+    Page* m_page;
+    RefPtr<Frame> m_frame;
+    int m_width;
+    int m_height;
+};
+
+BenchmarkPage::BenchmarkPage(int width, int height)
+    : m_width(width)
+    , m_height(height)
+{
     ScriptController::initializeThreading();
 
     // Setting this allows data: urls to load from a local file.
@@ -181,24 +223,23 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     notifyHistoryItemChanged = historyItemChanged;
 
     // Implement the shared timer callback
-    MyJavaSharedClient client;
-    JavaSharedClient::SetTimerClient(&client);
-    JavaSharedClient::SetCookieClient(&client);
+    JavaSharedClient::SetTimerClient(&m_client);
+    JavaSharedClient::SetCookieClient(&m_client);
 
     // Create the page with all the various clients
     ChromeClientAndroid* chrome = new ChromeClientAndroid;
     EditorClientAndroid* editor = new EditorClientAndroid;
-    Page* page = new Page(chrome,
-                          new ContextMenuClientAndroid,
-                          editor,
-                          new DragClientAndroid,
-                          new InspectorClientAndroid,
-                          0, // PluginHalterClient
-                          0); // GeolocationControllerClient
-    editor->setPage(page);
+    m_page = new Page(chrome,
+                      new ContextMenuClientAndroid,
+                      editor,
+                      new DragClientAndroid,
+                      new InspectorClientAndroid,
+                      0, // PluginHalterClient
+                      0); // GeolocationControllerClient
+    editor->setPage(m_page);
 
     // Create MyWebFrame that intercepts network requests
-    MyWebFrame* webFrame = new MyWebFrame(page);
+    MyWebFrame* webFrame = new MyWebFrame(m_page);
     webFrame->setUserAgent("Performance testing"); // needs to be non-empty
     chrome->setWebFrame(webFrame);
     // ChromeClientAndroid maintains the reference.
@@ -206,28 +247,28 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
 
     // Create the Frame and the FrameLoaderClient
     FrameLoaderClientAndroid* loader = new FrameLoaderClientAndroid(webFrame);
-    RefPtr<Frame> frame = Frame::create(page, NULL, loader);
-    loader->setFrame(frame.get());
+    m_frame = Frame::create(m_page, NULL, loader);
+    loader->setFrame(m_frame.get());
 
     // Build our View system, resize it to the given dimensions and release our
     // references. Note: We keep a referenec to frameView so we can layout and
     // draw later without risk of it being deleted.
     WebViewCore* webViewCore = new WebViewCore(JSC::Bindings::getJNIEnv(),
-            MY_JOBJECT, frame.get());
-    RefPtr<FrameView> frameView = FrameView::create(frame.get());
+            MY_JOBJECT, m_frame.get());
+    RefPtr<FrameView> frameView = FrameView::create(m_frame.get());
     WebFrameView* webFrameView = new WebFrameView(frameView.get(), webViewCore);
-    frame->setView(frameView);
+    m_frame->setView(frameView);
     frameView->resize(width, height);
     Release(webViewCore);
     Release(webFrameView);
 
     // Initialize the frame and turn of low-bandwidth display (it fails an
     // assertion in the Cache code)
-    frame->init();
-    frame->selection()->setFocused(true);
+    m_frame->init();
+    m_frame->selection()->setFocused(true);
 
     // Set all the default settings the Browser normally uses.
-    Settings* s = frame->settings();
+    Settings* s = m_frame->settings();
     s->setLayoutAlgorithm(Settings::kLayoutNormal); // Normal layout for now
     s->setStandardFontFamily("sans-serif");
     s->setFixedFontFamily("monospace");
@@ -245,46 +286,300 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     s->setPluginsEnabled(false);
     s->setShrinksStandaloneImagesToFit(false);
     s->setUseWideViewport(false);
+}
 
-    // Finally, load the actual data
+BenchmarkPage::~BenchmarkPage()
+{
+    // Tear down the world.
+    m_frame->loader()->detachFromParent();
+    delete m_page;
+}
+
+void BenchmarkPage::load(const char* url)
+{
     ResourceRequest req(url);
-    frame->loader()->load(req, false);
-
-    do {
-        // Layout the page and service the timer
-        frame->view()->layout();
-        while (client.m_hasTimer) {
-            client.m_func();
-            JavaSharedClient::ServiceFunctionPtrQueue();
-        }
-        JavaSharedClient::ServiceFunctionPtrQueue();
+    m_frame->loader()->load(req, false);
+    settle();
+}
+
+void BenchmarkPage::loadHTML(const char* html, size_t length)
+{
+    RefPtr<SharedBuffer> buffer = SharedBuffer::create(html, length);
+    SubstituteData data(buffer, "text/html", "utf-8", KURL());
+    m_frame->loader()->load(ResourceRequest(KURL(ParsedURLString,
+        "about:blank")), data, false);
+    settle();
+}
 
-        // Layout more if needed.
-        while (frame->view()->needsLayout())
-            frame->view()->layout();
+void BenchmarkPage::reload()
+{
+    m_frame->loader()->reload(true);
+    settle();
+}
+
+void BenchmarkPage::settle()
+{
+    // Layout the page and service the timer
+    m_frame->view()->layout();
+    while (m_client.m_hasTimer) {
+        m_client.m_func();
         JavaSharedClient::ServiceFunctionPtrQueue();
+    }
+    JavaSharedClient::ServiceFunctionPtrQueue();
 
-        if (reloadCount)
-            frame->loader()->reload(true);
-    } while (reloadCount--);
+    // Layout more if needed.
+    while (m_frame->view()->needsLayout())
+        m_frame->view()->layout();
+    JavaSharedClient::ServiceFunctionPtrQueue();
+}
+
+void BenchmarkPage::paint(SkCanvas* canvas)
+{
+    paint(canvas, IntRect(0, 0, m_width, m_height));
+}
+
+void BenchmarkPage::paint(SkCanvas* canvas, const IntRect& rect)
+{
+    PlatformGraphicsContext ctx(canvas, NULL);
+    GraphicsContext gc(&ctx);
+    m_frame->view()->paintContents(&gc, rect);
+}
+
+EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
+    BenchmarkPage page(width, height);
+
+    // Finally, load the actual data
+    page.load(url);
+    while (reloadCount--)
+        page.reload();
 
     // Draw into an offscreen bitmap
     SkBitmap bmp;
     bmp.setConfig(SkBitmap::kARGB_8888_Config, width, height);
     bmp.allocPixels();
     SkCanvas canvas(bmp);
-    PlatformGraphicsContext ctx(&canvas, NULL);
-    GraphicsContext gc(&ctx);
-    frame->view()->paintContents(&gc, IntRect(0, 0, width, height));
+    page.paint(&canvas);
 
     // Write the bitmap to the sdcard
     SkImageEncoder* enc = SkImageEncoder::Create(SkImageEncoder::kPNG_Type);
     enc->encodeFile("/sdcard/webcore_test.png", bmp, 100);
     delete enc;
+}
 
-    // Tear down the world.
-    frame->loader()->detachFromParent();
-    delete page;
+EXPORT bool benchmarkIsInstrumented()
+{
+#ifdef ANDROID_INSTRUMENT
+    return true;
+#else
+    return false;
+#endif
+}
+
+EXPORT void benchmarkPages(const char* const* urls, int urlCount,
+        int iterations, int warmup, int width, int height,
+        BenchmarkCallback callback, void* data)
+{
+    BenchmarkPage page(width, height);
+    for (int index = 0; index < urlCount; index++) {
+        for (int run = 0; run < warmup + iterations; run++) {
+            BenchmarkTiming timing;
+            memset(&timing, 0, sizeof(timing));
+#ifdef ANDROID_INSTRUMENT
+            TimeCounter::reset();
+#endif
+            double start = WTF::currentTime();
+            page.load(urls[index]);
+            timing.total = static_cast<int>((WTF::currentTime() - start) * 1000);
+
+            uint32_t recordStart = getThreadMsec();
+            SkPicture picture;
+            page.paint(picture.beginRecording(width, height));
+            picture.endRecording();
+            timing.record = getThreadMsec() - recordStart;
+#ifdef ANDROID_INSTRUMENT
+            timing.parse = TimeCounter::totalTime(TimeCounter::ParsingTimeCounter);
+            timing.style = TimeCounter::totalTime(TimeCounter::CalculateStyleTimeCounter);
+            timing.layout = TimeCounter::totalTime(TimeCounter::LayoutTimeCounter);
+            timing.javascript = TimeCounter::totalTime(TimeCounter::JavaScriptTimeCounter);
+#endif
+            bool isWarmup = run < warmup;
+            callback(index, isWarmup ? run : run - warmup, isWarmup, timing, data);
+        }
+    }
+}
+
+// Keeps the compiler from dropping loops whose results are otherwise unused.
+static volatile size_t benchmarkSink;
+
+static double megabytesPerSecond(size_t bytes, double seconds)
+{
+    return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0;
+}
+
+EXPORT void benchmarkTextScanning(int megabytes, TextScanTiming* timing)
+{
+    memset(timing, 0, sizeof(*timing));
+    size_t length = static_cast<size_t>(megabytes) * 1024 * 1024;
+    if (!length)
+        return;
+    // Prose with a tag every line and an entity now and then, like the
+    // text runs of a typical page.
+    static const char line[] = "Lorem ipsum dolor sit amet, consectetur "
+        "adipiscing elit, sed do eiusmod tempor incididunt &amp; labore <br>\n";
+    Vector<char> bytes(length);
+    for (size_t i = 0; i < length; i++)
+        bytes[i] = line[i % (sizeof(line) - 1)];
+    Vector<UChar> characters(length);
+
+    // The loop TextCodecLatin1 used, which widens and checks for non-ASCII
+    // bytes in the same pass.
+    double start = WTF::currentTime();
+    unsigned char ored = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = bytes[i];
+        characters[i] = c;
+        ored |= c;
+    }
+    timing->widenLoop = megabytesPerSecond(length, WTF::currentTime() - start);
+    benchmarkSink = !(ored & 0x80);
+    start = WTF::currentTime();
+    benchmarkSink = widenBytes(bytes.data(), characters.data(), length);
+    timing->widenKernel = megabytesPerSecond(length, WTF::currentTime() - start);
+
+    // Look for the characters that end a text run in the tokenizer, measured
+    // in bytes of the original text like the widening above.
+    size_t found = 0;
+    start = WTF::currentTime();
+    for (size_t i = 0; i < length; i++) {
+        UChar c = characters[i];
+        if (c == '<' || c == '&' || c == '\n' || c == '\r')
+            found++;
+    }
+    timing->scanLoop = megabytesPerSecond(length, WTF::currentTime() - start);
+    benchmarkSink = found;
+    found = 0;
+    start = WTF::currentTime();
+    for (size_t i = 0; i < length; i++) {
+        i += findFirstOf(characters.data() + i, length - i, '<', '&', '\n', '\r');
+        if (i < length)
+            found++;
+    }
+    timing->scanKernel = megabytesPerSecond(length, WTF::currentTime() - start);
+    benchmarkSink = found;
+}
+
+EXPORT void benchmarkScroll(const char* url, int threads, int width,
+        int height, ScrollTiming* timing)
+{
+    BenchmarkPage page(width, height);
+    memset(timing, 0, sizeof(*timing));
+    page.load(url);
+
+    FrameView* view = page.frame()->view();
+    int contentWidth = view->contentsWidth();
+    int contentHeight = view->contentsHeight();
+    PictureSet content;
+    SkRegion inval;
+    content.checkDimensions(contentWidth, contentHeight, &inval);
+    SkPicture* picture = new SkPicture();
+    page.paint(picture->beginRecording(contentWidth, contentHeight),
+        IntRect(0, 0, contentWidth, contentHeight));
+    picture->endRecording();
+    content.add(inval, picture, 0, false);
+    picture->unref();
+
+#if ENABLE(PICTURE_SET_TILE_CACHE)
+    // Each raster job plays back its own copy of the picture, and making
+    // those copies counts toward the frame times, as it does in the browser.
+    PictureSetTileCache::setRasterThreadCount(threads);
+    PictureSetTileCache cache;
+    const PictureSetTileCache::Statistics& tiles = PictureSetTileCache::statistics();
+    unsigned hits = tiles.hits;
+    unsigned misses = tiles.misses;
+#endif
+    SkBitmap bitmap;
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height);
+    bitmap.allocPixels();
+    SkCanvas canvas(bitmap);
+
+    // A steady fling, one frame every 1/60 second.
+    const int scrollStep = 24;
+    const double frameTime = 1.0 / 60;
+    int maxScroll = std::max(contentHeight - height, 0);
+    double total = 0;
+    for (int y = 0; ; y = std::min(y + scrollStep, maxScroll)) {
+        canvas.save();
+        canvas.translate(0, SkIntToScalar(-y));
+        double start = WTF::currentTime();
+#if ENABLE(PICTURE_SET_TILE_CACHE)
+        cache.draw(&canvas, content, false);
+#else
+        content.draw(&canvas);
+#endif
+        double elapsed = WTF::currentTime() - start;
+        canvas.restore();
+        total += elapsed;
+        timing->longest = std::max(timing->longest, elapsed * 1000);
+        timing->frames++;
+        if (y == maxScroll)
+            break;
+        if (elapsed < frameTime)
+            usleep(static_cast<useconds_t>((frameTime - elapsed) * 1000000));
+    }
+    timing->average = total * 1000 / timing->frames;
+#if ENABLE(PICTURE_SET_TILE_CACHE)
+    timing->tileHits = tiles.hits - hits;
+    timing->tileMisses = tiles.misses - misses;
+#endif
+}
+
+EXPORT void benchmarkNavCache(int linkCount, int queries, int width,
+        int height, NavCacheTiming* timing)
+{
+    BenchmarkPage page(width, height);
+    memset(timing, 0, sizeof(*timing));
+
+    // Lines of short links, like a link-dense index or forum page.
+    Vector<char> html;
+    char text[128];
+    int length = snprintf(text, sizeof(text), "<html><body>");
+    html.append(text, length);
+    for (int index = 0; index < linkCount; index++) {
+        length = snprintf(text, sizeof(text), "<a href=\"l%d\">link %d</a>%s",
+            index, index, index % 8 == 7 ? "<br>" : " ");
+        html.append(text, length);
+    }
+    length = snprintf(text, sizeof(text), "</body></html>");
+    html.append(text, length);
+    page.loadHTML(html.data(), html.size());
+
+    Frame* frame = page.frame();
+    CachedHistory history;
+    CachedRoot root;
+    double start = WTF::currentTime();
+    root.init(frame, &history);
+    FrameLoaderClientAndroid::get(frame)->getCacheBuilder().buildCache(&root);
+    timing->build = static_cast<int>((WTF::currentTime() - start) * 1000);
+    root.setVisibleRect(IntRect(0, 0, width, height));
+    timing->nodes = root.size();
+
+    int documentWidth = std::max(root.documentWidth(), 1);
+    int documentHeight = std::max(root.documentHeight(), 1);
+    // Roughly a fingertip, as WebView hit tests touches with.
+    const int slop = 10;
+    start = WTF::currentTime();
+    for (int query = 0; query < queries; query++) {
+        // Fixed pseudo random points, so runs can be compared.
+        int x = static_cast<int>((query * 7919LL) % documentWidth);
+        int y = static_cast<int>((query * 104729LL) % documentHeight);
+        const CachedFrame* cachedFrame;
+        int hitX, hitY;
+        if (root.findAt(IntRect(x - slop, y - slop, slop * 2, slop * 2),
+                &cachedFrame, &hitX, &hitY, false))
+            timing->hits++;
+    }
+    if (queries > 0)
+        timing->hitTest = (WTF::currentTime() - start) * 1000000 / queries;
 }
 
 }  // namespace android
@@ -154,11 +154,23 @@ FILE* gRenderTreeFile = 0;
  */
 #define PICT_RECORD_FLAGS   SkPicture::kUsePathBoundsForClip_RecordingFlag
 
+#if ENABLE(PICTURE_SET_GRID)
+// Content invalidated after the first recording is recorded again in square
+// cells this size, in content pixels.
+#define GRID_CELL_SIZE 256
+#endif
+
+#if ENABLE(PICTURE_SET_COMPACTION)
+// Seconds between finding the content worth compacting and compacting it.
+#define CONTENT_COMPACTION_DELAY 1.0
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 namespace android {
 
 static SkTDArray<WebViewCore*> gInstanceList;
+static WebViewCore::RecordStatistics gRecordStatistics;
 
 void WebViewCore::addInstance(WebViewCore* inst) {
     *gInstanceList.append() = inst;
@@ -302,6 +314,9 @@ Mutex WebViewCore::m_contentMutex;
 
 WebViewCore::WebViewCore(JNIEnv* env, jobject javaWebViewCore, WebCore::Frame* mainframe)
         : m_pluginInvalTimer(this, &WebViewCore::pluginInvalTimerFired)
+#if ENABLE(PICTURE_SET_COMPACTION)
+        , m_compactContentTimer(this, &WebViewCore::compactContentTimerFired)
+#endif
 {
     m_mainFrame = mainframe;
 
@@ -633,6 +648,10 @@ void WebViewCore::recordPictureSet(PictureSet* content)
     // are marked as invalid, and are rebuilt by rebuildPictureSet().
 
     // If the new region doesn't match a set of split pieces, add it to the end.
+#if ENABLE(PICTURE_SET_GRID)
+    if (!content->reuseSubdivided(m_addInval))
+        recordGridCells(content, width, height);
+#else
     if (!content->reuseSubdivided(m_addInval)) {
         const SkIRect& inval = m_addInval.getBounds();
         SkPicture* picture = rebuildPicture(inval);
@@ -641,6 +660,7 @@ void WebViewCore::recordPictureSet(PictureSet* content)
         content->add(m_addInval, picture, 0, false);
         picture->safeUnref();
     }
+#endif
     // Remove any pictures already in the set that are obscured by the new one,
     // and check to see if any already split pieces need to be redrawn.
     if (content->build())
@@ -779,6 +799,9 @@ void WebViewCore::clearContent()
     DBG_SET_LOG("");
     m_contentMutex.lock();
     m_content.clear();
+#if ENABLE(PICTURE_SET_TILE_CACHE)
+    m_tileCache.invalidateAll();
+#endif
 
 #if ENABLE(ACCELERATED_SCROLLING)
     m_scrollRenderer->clearContent();
@@ -815,6 +838,9 @@ bool WebViewCore::drawContent(SkCanvas* canvas, SkColor color)
 
     m_contentMutex.lock();
     PictureSet copyContent = PictureSet(m_content);
+#if ENABLE(PICTURE_SET_TILE_CACHE)
+    m_tileCache.takeInvalidations();
+#endif
     m_contentMutex.unlock();
 
 #if ENABLE(ACCELERATED_SCROLLING)
@@ -836,10 +862,15 @@ bool WebViewCore::drawContent(SkCanvas* canvas, SkColor color)
     canvas->drawColor(color);
     canvas->restoreToCount(sc);
 #if ENABLE(COLOR_INVERSION)
-    bool tookTooLong = copyContent.draw(canvas, m_invertColor);
+    bool invertColor = m_invertColor;
 #else
-    bool tookTooLong = copyContent.draw(canvas);
+    bool invertColor = false;
 #endif //COLOR_INVERSION
+#if ENABLE(PICTURE_SET_TILE_CACHE)
+    bool tookTooLong = m_tileCache.draw(canvas, copyContent, invertColor);
+#else
+    bool tookTooLong = copyContent.draw(canvas, invertColor);
+#endif
 #if !ENABLE(ACCELERATED_SCROLLING)
     DBG_SET_LOG("end");
     return tookTooLong;
@@ -884,6 +915,8 @@ SkPicture* WebViewCore::rebuildPicture(const SkIRect& inval)
     SkAutoPictureRecord arp(picture, width, height, PICT_RECORD_FLAGS);
     SkAutoMemoryUsageProbe mup(__FUNCTION__);
     SkCanvas* recordingCanvas = arp.getRecordingCanvas();
+    gRecordStatistics.pictures++;
+    gRecordStatistics.recordedArea += (uint64_t) inval.width() * inval.height();
 
     gButtonMutex.lock();
     WTF::Vector<Container> buttons(m_buttons);
@@ -922,6 +955,112 @@ void WebViewCore::rebuildPictureSet(PictureSet* pictureSet)
     pictureSet->validate(__FUNCTION__);
 }
 
+#if ENABLE(PICTURE_SET_GRID)
+// Records the invalidated content one grid cell at a time. Each cell becomes
+// its own picture, so a later change only replaces the cells it touches,
+// instead of partially covering a larger picture that then has to be
+// recorded again along with every base picture under it. Cells are added as
+// split pieces so that splitContent() keeps them apart, and so that
+// reuseSubdivided() records a cell invalidated on its own in place.
+void WebViewCore::recordGridCells(PictureSet* content, int width, int height)
+{
+    SkIRect contentRect;
+    contentRect.set(0, 0, width, height);
+    SkIRect bounds = m_addInval.getBounds();
+    if (!bounds.intersect(contentRect))
+        return;
+    WTF::Vector<SkIRect> cells;
+    uint64_t cellArea = 0;
+    for (int top = bounds.fTop / GRID_CELL_SIZE * GRID_CELL_SIZE;
+            top < bounds.fBottom; top += GRID_CELL_SIZE) {
+        for (int left = bounds.fLeft / GRID_CELL_SIZE * GRID_CELL_SIZE;
+                left < bounds.fRight; left += GRID_CELL_SIZE) {
+            SkIRect cell;
+            cell.set(left, top, left + GRID_CELL_SIZE, top + GRID_CELL_SIZE);
+            if (!cell.intersect(contentRect) || !m_addInval.intersects(cell))
+                continue;
+            cells.append(cell);
+            cellArea += (uint64_t) cell.width() * cell.height();
+        }
+    }
+    // When most of the content changed, as on the first recording, one
+    // picture of all of it is cheaper to record and to draw, and becomes the
+    // base that later cells are drawn over.
+    if (cellArea * 2 > (uint64_t) width * height) {
+        SkPicture* picture = rebuildPicture(contentRect);
+        DBG_SET_LOGD("all {w=%d,h=%d}", width, height);
+        content->add(SkRegion(contentRect), picture, 0, false);
+        picture->safeUnref();
+        return;
+    }
+    for (size_t i = 0; i < cells.size(); i++) {
+        const SkIRect& cell = cells[i];
+        SkPicture* picture = rebuildPicture(cell);
+        DBG_SET_LOGD("cell {%d,%d,w=%d,h=%d}", cell.fLeft, cell.fTop,
+            cell.width(), cell.height());
+        content->add(SkRegion(cell), picture, 0, true);
+        picture->safeUnref();
+    }
+}
+#endif
+
+const WebViewCore::RecordStatistics& WebViewCore::recordStatistics()
+{
+    return gRecordStatistics;
+}
+
+void WebViewCore::reportContentMemoryUsage()
+{
+    for (int i = 0; i < gInstanceList.count(); i++) {
+        WebViewCore* core = gInstanceList[i];
+        m_contentMutex.lock();
+        size_t pictures = core->m_content.size();
+        size_t bytes = core->m_content.memoryUsage();
+        m_contentMutex.unlock();
+        LOGD("Content of view %p uses %d bytes in %d pictures", core, bytes,
+            pictures);
+    }
+}
+
+#if ENABLE(PICTURE_SET_COMPACTION)
+// Records the content again as one picture once recordContent() has left
+// enough of it drawn over by later pictures. The result draws the same
+// pixels, so nothing is invalidated. A single recording also shares the
+// paints and bitmaps that separate recordings each keep a copy of.
+void WebViewCore::compactContent()
+{
+    // Content that changed since it was last recorded is left to
+    // recordContent(), which is already on its way.
+    if (!layoutIfNeededRecursive(m_mainFrame) || !m_addInval.isEmpty())
+        return;
+    m_contentMutex.lock();
+    PictureSet contentCopy(m_content);
+    m_contentMutex.unlock();
+    WebCore::FrameView* view = m_mainFrame->view();
+    if (!contentCopy.needsCompaction()
+            || contentCopy.width() != view->contentsWidth()
+            || contentCopy.height() != view->contentsHeight())
+        return;
+    DBG_SET_LOGD("compact %d pictures", contentCopy.size());
+    SkIRect contentRect;
+    contentRect.set(0, 0, contentCopy.width(), contentCopy.height());
+    SkRegion rebuildInval(m_rebuildInval);
+    SkPicture* picture = rebuildPicture(contentRect);
+    m_rebuildInval = rebuildInval;
+    // The new picture covers all the others, which build() drops.
+    contentCopy.add(SkRegion(contentRect), picture, 0, false);
+    picture->safeUnref();
+    contentCopy.build();
+    gRecordStatistics.compactions++;
+    m_contentMutex.lock();
+    m_content.set(contentCopy);
+#if ENABLE(ACCELERATED_SCROLLING)
+    m_scrollRenderer->setContent(m_content, 0, false);
+#endif
+    m_contentMutex.unlock();
+}
+#endif
+
 bool WebViewCore::recordContent(SkRegion* region, SkIPoint* point)
 {
     DBG_SET_LOG("start");
@@ -930,7 +1069,14 @@ bool WebViewCore::recordContent(SkRegion* region, SkIPoint* point)
     PictureSet contentCopy(m_content);
     m_progressDone = progress <= 0.0f || progress >= 1.0f;
     m_contentMutex.unlock();
+    uint64_t recordedArea = gRecordStatistics.recordedArea;
     recordPictureSet(&contentCopy);
+    if (gRecordStatistics.recordedArea != recordedArea) {
+        uint64_t updateArea = gRecordStatistics.recordedArea - recordedArea;
+        gRecordStatistics.updates++;
+        if (gRecordStatistics.maxUpdateArea < updateArea)
+            gRecordStatistics.maxUpdateArea = updateArea;
+    }
     if (!m_progressDone && contentCopy.isEmpty()) {
         DBG_SET_LOGD("empty (progress=%g)", progress);
         return false;
@@ -942,6 +1088,9 @@ bool WebViewCore::recordContent(SkRegion* region, SkIPoint* point)
     m_contentMutex.lock();
     contentCopy.setDrawTimes(m_content);
     m_content.set(contentCopy);
+#if ENABLE(PICTURE_SET_TILE_CACHE)
+    m_tileCache.invalidate(*region);
+#endif
 
 
 #if ENABLE(ACCELERATED_SCROLLING)
@@ -951,6 +1100,12 @@ bool WebViewCore::recordContent(SkRegion* region, SkIPoint* point)
 #endif
     point->fX = m_content.width();
     point->fY = m_content.height();
+#if ENABLE(PICTURE_SET_COMPACTION)
+    // Compacting waits for a moment when the page is idle, but does not wait
+    // for one that never comes on a page that keeps changing.
+    if (m_content.needsCompaction() && !m_compactContentTimer.isActive())
+        m_compactContentTimer.startOneShot(CONTENT_COMPACTION_DELAY);
+#endif
     m_contentMutex.unlock();
     DBG_SET_LOGD("region={%d,%d,r=%d,b=%d}", region->getBounds().fLeft,
         region->getBounds().fTop, region->getBounds().fRight,
@@ -31,6 +31,7 @@
 #include "CacheBuilder.h"
 #include "CachedHistory.h"
 #include "PictureSet.h"
+#include "PictureSetTileCache.h"
 #include "PlatformGraphicsContext.h"
 #include "SkColor.h"
 #include "SkTDArray.h"
@@ -464,6 +465,18 @@ namespace android {
         // utility to split slow parts of the picture set
         void splitContent();
 
+        struct RecordStatistics {
+            unsigned updates; // recordContent() calls that recorded anything
+            unsigned pictures;
+            uint64_t recordedArea; // in content pixels
+            uint64_t maxUpdateArea; // the most recorded by a single update
+            unsigned compactions;
+        };
+        // Sum over all views.
+        static const RecordStatistics& recordStatistics();
+        // Logs the size of the recorded content of each view.
+        static void reportContentMemoryUsage();
+
         // these members are shared with webview.cpp
         static Mutex gFrameCacheMutex;
         CachedRoot* m_frameCacheKit; // nav data being built by webcore
@@ -518,6 +531,9 @@ namespace android {
         int m_lastFocusedSelEnd;
         static Mutex m_contentMutex; // protects ui/core thread pictureset access
         PictureSet m_content; // the set of pictures to draw (accessed by UI too)
+#if ENABLE(PICTURE_SET_TILE_CACHE)
+        PictureSetTileCache m_tileCache; // tiles of m_content drawn by the UI thread, rasterized by worker threads
+#endif
         SkRegion m_addInval; // the accumulated inval region (not yet drawn)
         SkRegion m_rebuildInval; // the accumulated region for rebuilt pictures
         // Used in passToJS to avoid updating the UI text field until after the
@@ -555,10 +571,20 @@ namespace android {
         void pluginInvalTimerFired(WebCore::Timer<WebViewCore>*) {
             this->drawPlugins();
         }
+#if ENABLE(PICTURE_SET_COMPACTION)
+        WebCore::Timer<WebViewCore> m_compactContentTimer;
+        void compactContentTimerFired(WebCore::Timer<WebViewCore>*) {
+            this->compactContent();
+        }
+        void compactContent();
+#endif
 
         void doMaxScroll(CacheBuilder::Direction dir);
         SkPicture* rebuildPicture(const SkIRect& inval);
         void rebuildPictureSet(PictureSet* );
+#if ENABLE(PICTURE_SET_GRID)
+        void recordGridCells(PictureSet* , int width, int height);
+#endif
         void sendNotifyProgressFinished();
         bool handleMouseClick(WebCore::Frame* framePtr, WebCore::Node* nodePtr);
         WebCore::HTMLAnchorElement* retrieveAnchorElement(WebCore::Frame* frame, WebCore::Node* node);
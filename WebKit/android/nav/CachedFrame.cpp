@@ -364,7 +364,10 @@ const CachedNode* CachedFrame::findBestAt(const WebCore::IntRect& rect,
     WebCore::IntPoint center = WebCore::IntPoint(rect.x() + (rectWidth >> 1),
         rect.y() + (rect.height() >> 1));
     mRoot->setupScrolledBounds();
-    for (const CachedNode* test = mCachedNodes.begin(); test != mCachedNodes.end(); test++) {
+    WTF::Vector<int> candidates;
+    mNodeIndex.find(rect, &candidates);
+    for (const int* index = candidates.begin(); index != candidates.end(); index++) {
+        const CachedNode* test = &mCachedNodes[*index];
         if (test->disabled())
             continue;
         size_t parts = test->navableRects();
@@ -481,8 +484,10 @@ const CachedNode* CachedFrame::findBestHitAt(const WebCore::IntRect& rect,
         if (NULL != frameResult)
             return frameResult;
     }
-    for (const CachedNode* test = mCachedNodes.end() - 1;
-            test != mCachedNodes.begin() - 1; test--) {
+    WTF::Vector<int> candidates;
+    mNodeIndex.find(rect, &candidates);
+    for (size_t index = candidates.size(); index-- > 0; ) {
+        const CachedNode* test = &mCachedNodes[candidates[index]];
         if (test->disabled())
             continue;
         WebCore::IntRect testRect = test->hitBounds(this);
@@ -513,8 +518,12 @@ const CachedNode* CachedFrame::findBestHitAt(const WebCore::IntRect& rect,
 void CachedFrame::findClosest(BestData* bestData, Direction originalDirection,
     Direction direction, WebCore::IntRect* clip) const
 {
-    const CachedNode* test = mCachedNodes.begin();
-    while ((test = test->traverseNextNode()) != NULL) {
+    WTF::Vector<int> candidates;
+    mNodeIndex.find(*clip, &candidates);
+    for (const int* index = candidates.begin(); index != candidates.end(); index++) {
+        if (*index == 0) // the document
+            continue;
+        const CachedNode* test = &mCachedNodes[*index];
         const CachedFrame* child = hasFrame(test);
         if (child != NULL) {
             const CachedNode* childDoc = child->validDocument();
@@ -599,6 +608,7 @@ void CachedFrame::finishInit()
 {
     CachedNode* lastCached = lastNode();
     lastCached->setLast();
+    mNodeIndex.build(this, mCachedNodes.begin(), mCachedNodes.size());
     CachedFrame* child = mCachedFrames.begin();
     while (child != mCachedFrames.end()) {
         child->mParent = this;
@@ -29,6 +29,7 @@
 #include "CachedInput.h"
 #include "CachedLayer.h"
 #include "CachedNode.h"
+#include "CachedNodeIndex.h"
 #include "IntRect.h"
 #include "SkFixed.h"
 #include "wtf/Vector.h"
@@ -225,6 +226,7 @@ private: // since computing these is complicated, protect them so that the
     WebCore::IntRect mLocalViewBounds;
     WebCore::IntRect mViewBounds;
     WTF::Vector<CachedNode> mCachedNodes;
+    CachedNodeIndex mNodeIndex; // mCachedNodes by location
     WTF::Vector<CachedFrame> mCachedFrames;
     WTF::Vector<CachedInput> mCachedTextInputs;
 #if USE(ACCELERATED_COMPOSITING)
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CachedPrefix.h"
+
+#include "CachedFrame.h"
+#include "CachedNode.h"
+#include "CachedNodeIndex.h"
+#include <algorithm>
+
+#define CELL_SIZE 256 // in content pixels; doubled for large frames
+#define MAX_CELLS 16384
+#define MAX_NODE_CELLS 16 // nodes covering more are not bucketed
+#define MIN_INDEXED_NODES 32 // smaller frames are searched node by node
+
+namespace android {
+
+void CachedNodeIndex::build(const CachedFrame* frame, const CachedNode* nodes,
+    int count)
+{
+    mBounds = WebCore::IntRect(0, 0, 0, 0);
+    mCellSize = CELL_SIZE;
+    mColumns = mRows = 0;
+    mNodeCount = count;
+    mCellStarts.clear();
+    mCellNodes.clear();
+    mUnbucketed.clear();
+    if (count < MIN_INDEXED_NODES)
+        return;
+    WTF::Vector<WebCore::IntRect> extents(count);
+    for (int index = 0; index < count; index++) {
+        const CachedNode& node = nodes[index];
+        if (node.isInLayer() || node.isFrame())
+            continue;
+        WebCore::IntRect& extent = extents[index];
+        extent = node.bounds(frame);
+        extent.unite(node.hitBounds(frame));
+        for (int part = 0; part < node.navableRects(); part++)
+            extent.unite(node.ring(frame, part));
+        mBounds.unite(extent);
+    }
+    if (mBounds.isEmpty())
+        return;
+    mColumns = (mBounds.width() + mCellSize - 1) / mCellSize;
+    mRows = (mBounds.height() + mCellSize - 1) / mCellSize;
+    while (mColumns * mRows > MAX_CELLS) {
+        mCellSize <<= 1;
+        mColumns = (mBounds.width() + mCellSize - 1) / mCellSize;
+        mRows = (mBounds.height() + mCellSize - 1) / mCellSize;
+    }
+    // Count the nodes in each cell, then fill the cells in document order so
+    // that every cell lists its nodes sorted.
+    int cells = mColumns * mRows;
+    mCellStarts.fill(0, cells + 1);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int index = 0; index < count; index++) {
+            const CachedNode& node = nodes[index];
+            if (node.isInLayer() || node.isFrame()) {
+                if (pass == 0)
+                    mUnbucketed.append(index);
+                continue;
+            }
+            const WebCore::IntRect& extent = extents[index];
+            if (extent.isEmpty()) // can't intersect anything
+                continue;
+            int firstColumn, firstRow, lastColumn, lastRow;
+            cellRange(extent, &firstColumn, &firstRow, &lastColumn, &lastRow);
+            if ((lastColumn - firstColumn + 1) * (lastRow - firstRow + 1)
+                    > MAX_NODE_CELLS) {
+                if (pass == 0)
+                    mUnbucketed.append(index);
+                continue;
+            }
+            for (int row = firstRow; row <= lastRow; row++) {
+                for (int column = firstColumn; column <= lastColumn; column++) {
+                    int cell = row * mColumns + column;
+                    if (pass == 0)
+                        mCellStarts[cell + 1]++;
+                    else
+                        mCellNodes[mCellStarts[cell]++] = index;
+                }
+            }
+        }
+        if (pass == 0) {
+            for (int cell = 0; cell < cells; cell++)
+                mCellStarts[cell + 1] += mCellStarts[cell];
+            mCellNodes.resize(mCellStarts[cells]);
+        } else {
+            // filling advanced each start to the next cell's start
+            for (int cell = cells; cell > 0; cell--)
+                mCellStarts[cell] = mCellStarts[cell - 1];
+            mCellStarts[0] = 0;
+        }
+    }
+    DBG_NAV_LOGD("nodes=%d cells=%dx%d size=%d bucketed=%d unbucketed=%d",
+        count, mColumns, mRows, mCellSize, mCellNodes.size(),
+        mUnbucketed.size());
+}
+
+void CachedNodeIndex::cellRange(const WebCore::IntRect& rect, int* firstColumn,
+    int* firstRow, int* lastColumn, int* lastRow) const
+{
+    *firstColumn = (rect.x() - mBounds.x()) / mCellSize;
+    *firstRow = (rect.y() - mBounds.y()) / mCellSize;
+    *lastColumn = (rect.right() - 1 - mBounds.x()) / mCellSize;
+    *lastRow = (rect.bottom() - 1 - mBounds.y()) / mCellSize;
+}
+
+void CachedNodeIndex::find(const WebCore::IntRect& rect,
+    WTF::Vector<int>* result) const
+{
+    result->clear();
+    if (mColumns == 0) {
+        result->reserveCapacity(mNodeCount);
+        for (int index = 0; index < mNodeCount; index++)
+            result->append(index);
+        return;
+    }
+    result->append(mUnbucketed.begin(), mUnbucketed.size());
+    WebCore::IntRect area = rect;
+    area.intersect(mBounds);
+    if (area.isEmpty())
+        return;
+    int firstColumn, firstRow, lastColumn, lastRow;
+    cellRange(area, &firstColumn, &firstRow, &lastColumn, &lastRow);
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            int cell = row * mColumns + column;
+            result->append(mCellNodes.begin() + mCellStarts[cell],
+                mCellStarts[cell + 1] - mCellStarts[cell]);
+        }
+    }
+    // nodes spanning cells were found once per cell
+    std::sort(result->begin(), result->end());
+    int* end = std::unique(result->begin(), result->end());
+    result->shrink(end - result->begin());
+}
+
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2010, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE COMPUTER, INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CachedNodeIndex_H
+#define CachedNodeIndex_H
+
+#include "IntRect.h"
+#include "wtf/Vector.h"
+
+namespace android {
+
+class CachedFrame;
+class CachedNode;
+
+// Buckets the nodes of one frame by the grid cells their rectangles cover,
+// so that hit tests and searches limited to an area look only at the nodes
+// near it instead of at every node in the frame. Nodes in layers move with
+// the layer, nodes that own a frame are searched whatever their bounds, and
+// nodes that cover many cells would fill most of the grid; these are
+// returned by every query instead. Frames with few nodes are not indexed.
+class CachedNodeIndex {
+public:
+    CachedNodeIndex() : mCellSize(0), mColumns(0), mRows(0), mNodeCount(0) {}
+    void build(const CachedFrame* , const CachedNode* nodes, int count);
+    // Sets the indices, in document order, of the nodes whose bounds, hit
+    // bounds or cursor rings may intersect the rectangle.
+    void find(const WebCore::IntRect& , WTF::Vector<int>* ) const;
+private:
+    void cellRange(const WebCore::IntRect& , int* firstColumn, int* firstRow,
+        int* lastColumn, int* lastRow) const;
+    WebCore::IntRect mBounds; // the area covered by the cells
+    int mCellSize;
+    int mColumns; // zero if the frame is not indexed
+    int mRows;
+    int mNodeCount;
+    WTF::Vector<int> mCellStarts; // where each cell starts in mCellNodes
+    WTF::Vector<int> mCellNodes;
+    WTF::Vector<int> mUnbucketed;
+};
+
+}
+
+#endif
@@ -34,6 +34,9 @@
 #include "Frame.h"
 #include "RenderTreeAsText.h"
 #include "RenderView.h"
+#ifdef ANDROID_INSTRUMENT
+#include "StyleRecalcStatistics.h"
+#endif
 #include "WebViewCore.h"
 #include <utils/Log.h>
 
@@ -73,6 +76,21 @@ static bool callDumpDomTree(const Frame* frame, const Connection* conn) {
     return true;
 }
 
+#ifdef ANDROID_INSTRUMENT
+static bool callDumpStyleRecalcStatistics(const Frame*, const Connection* conn) {
+    CString str = StyleRecalcStatistics::dump().utf8();
+    conn->write(str.data(), str.length());
+    return true;
+}
+
+static bool callToggleStyleRecalcTracing(const Frame*, const Connection* conn) {
+    bool tracing = !StyleRecalcStatistics::isTracing();
+    StyleRecalcStatistics::setTracing(tracing);
+    conn->write(tracing ? "Style invalidations logged to logcat\n" : "Style invalidation logging off\n");
+    return true;
+}
+#endif
+
 class WebCoreHandler : public Handler {
 public:
     virtual void post(TargetThreadFunction func, void* v) const {
@@ -128,6 +146,12 @@ void Command::Init() {
                 callDumpDomTree, s_webcoreHandler));
     s_commands->append(new Command("DDRT", "Dump Render Tree",
                 callDumpRenderTree, s_webcoreHandler));
+#ifdef ANDROID_INSTRUMENT
+    s_commands->append(new Command("DSTY", "Dump Style Recalc Statistics",
+                callDumpStyleRecalcStatistics, s_webcoreHandler));
+    s_commands->append(new Command("TSTY", "Toggle Style Invalidation Tracing",
+                callToggleStyleRecalcTracing, s_webcoreHandler));
+#endif
 }
 
 Command* Command::Find(const Connection* conn) {